@@ -0,0 +1,122 @@
+// board_scorer.h - Line scores of every cell of a PaddedBoard in one pass
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "patterns.h"
+#include "padded_board.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BOARD_SCORER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// For every cell, the sum over the four directions of table[line key] as
+// black and as white would see a stone there: the scores the greedy
+// engines' evaluatePosition gives a cell, less any positional bonus. Scores
+// are indexed like the board (PaddedBoard::index) and are computed for
+// occupied and padding cells too; callers skip those.
+//
+// The AVX2 kernel builds the keys of eight cells at once from unaligned
+// byte loads, one per neighbour, and looks the scores up with gathers. The
+// board's cell values are black's pattern codes, and white's keys are
+// black's with each bit pair swapped, so neither needs a translation. The
+// kernel is chosen at run time when the processor supports AVX2; the
+// scalar loop gives the same scores.
+class BoardScorer {
+public:
+    using Scores = std::array<int, PaddedBoard::CELLS>;
+
+    static void scoreAll(const PaddedBoard& board, const int* table, Scores& black, Scores& white) {
+        static const auto kernel = hasAvx2() ? scoreAllAvx2 : scoreAllScalar;
+        kernel(board, table, black, white);
+    }
+
+    static void scoreAllScalar(const PaddedBoard& board, const int* table, Scores& black, Scores& white) {
+        for (int i = FIRST; i < LAST; i++) {
+            int blackScore = 0;
+            int whiteScore = 0;
+            for (int step : PaddedBoard::DIRECTIONS) {
+                blackScore += table[board.lineKey(i, step, PaddedBoard::BLACK)];
+                whiteScore += table[board.lineKey(i, step, PaddedBoard::WHITE)];
+            }
+            black[i] = blackScore;
+            white[i] = whiteScore;
+        }
+    }
+
+#ifdef BOARD_SCORER_X86
+    static bool hasAvx2() {
+#if defined(__GNUC__)
+        return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#else
+        return false;
+#endif
+    }
+
+#if defined(__GNUC__)
+    __attribute__((target("avx2")))
+#endif
+    static void scoreAllAvx2(const PaddedBoard& board, const int* table, Scores& black, Scores& white) {
+        const uint8_t* cells = board.data();
+        const __m256i lowBits = _mm256_set1_epi32(0x5555);
+        const __m256i highBits = _mm256_set1_epi32(0xAAAA);
+
+        for (int i = FIRST; i < LAST; i += LANES) {
+            __m256i blackScore = _mm256_setzero_si256();
+            __m256i whiteScore = _mm256_setzero_si256();
+            for (int step : PaddedBoard::DIRECTIONS) {
+                // Board cells are black's pattern codes as they are
+                __m256i blackKey = _mm256_setzero_si256();
+                for (int n = 0; n < LinePatterns::NEIGHBOURS; n++) {
+                    const uint8_t* neighbours = cells + i + LinePatterns::offset(n) * step;
+                    __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(neighbours));
+                    blackKey = _mm256_or_si256(blackKey, _mm256_sll_epi32(_mm256_cvtepu8_epi32(raw),
+                                                                          _mm_cvtsi32_si128(2 * n)));
+                }
+                // White sees OWN and OPPONENT swapped: swap the bits of every pair
+                __m256i whiteKey = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(blackKey, lowBits), 1),
+                                                   _mm256_srli_epi32(_mm256_and_si256(blackKey, highBits), 1));
+                blackScore = _mm256_add_epi32(blackScore, _mm256_i32gather_epi32(table, blackKey, 4));
+                whiteScore = _mm256_add_epi32(whiteScore, _mm256_i32gather_epi32(table, whiteKey, 4));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(black.data() + i), blackScore);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(white.data() + i), whiteScore);
+        }
+    }
+#else
+    static bool hasAvx2() { return false; }
+
+    static void scoreAllAvx2(const PaddedBoard& board, const int* table, Scores& black, Scores& white) {
+        scoreAllScalar(board, table, black, white);
+    }
+#endif
+
+private:
+    static constexpr int LANES = 8;
+
+    static_assert(int(PaddedBoard::EMPTY) == LinePatterns::EMPTY && int(PaddedBoard::BLACK) == LinePatterns::OWN &&
+                      int(PaddedBoard::WHITE) == LinePatterns::OPPONENT &&
+                      int(PaddedBoard::BORDER) == LinePatterns::EDGE,
+                  "board cells double as black's pattern codes");
+
+    // Cells from the top-left to the bottom-right board cell; the vector
+    // kernel rounds the span up to whole lanes, which stays inside the
+    // padded arrays
+    static constexpr int FIRST = PaddedBoard::index(0, 0);
+    static constexpr int LAST = PaddedBoard::index(PaddedBoard::SIZE - 1, PaddedBoard::SIZE - 1) + 1;
+
+    static_assert(FIRST + (LAST - FIRST + LANES - 1) / LANES * LANES + LinePatterns::REACH * (PaddedBoard::STRIDE + 1) <=
+                      PaddedBoard::CELLS,
+                  "vector loads must stay inside the padded board");
+};
@@ -8,7 +8,7 @@
 #include <chrono>
 #include <thread>
 #include <array>
-#include <unordered_set>
+#include "patterns.h"
 
 class Gomoku {
 private:
@@ -24,9 +24,11 @@ private:
     // Use array instead of vector for better cache locality
     std::array<std::array<int, BOARD_SIZE>, BOARD_SIZE> board;
     
-    // Precomputed neighbor positions for faster move generation
-    std::vector<std::pair<int, int>> occupiedPositions;
-    std::unordered_set<int> consideredMoves; // Using hash for O(1) lookup
+    // Candidate moves for each search radius, maintained by makeMove: per
+    // row, a bit mask of the empty cells within that radius of a stone.
+    // Stones are never taken back, so no per-cell counts are needed.
+    static constexpr int MAX_RADIUS = 2;
+    std::array<std::array<uint16_t, BOARD_SIZE>, MAX_RADIUS> candidateRows;
     
     int currentPlayer;
     bool gameOver;
@@ -52,6 +54,53 @@ private:
         }
     };
     
+    // Score of a stone's shape in one direction, indexed by line key;
+    // WIN_SCORE for five in a row
+    static const std::array<int, LinePatterns::KEY_COUNT> LINE_SCORES;
+    
+    static int scoreLine(const LinePatterns::Window& window) {
+        int playerCount = 0, opponentCount = 0;
+        int openEnds = 0;
+        
+        // Check line in both directions from the position
+        for (int sign = -1; sign <= 1; sign += 2) {
+            int i = LinePatterns::REACH + sign;
+            int consecutive = 0;
+            while (i >= 0 && i <= LinePatterns::NEIGHBOURS && window[i] == LinePatterns::OWN) {
+                playerCount++;
+                consecutive++;
+                i += sign;
+            }
+            
+            LinePatterns::Cell end = LinePatterns::pastRun(window, sign);
+            if (end == LinePatterns::OPPONENT) {
+                opponentCount++;
+            } else if (end == LinePatterns::EMPTY) {
+                if (consecutive > 0) openEnds++;
+            } else if (consecutive == 0) {
+                openEnds++; // Line extends to edge
+            }
+        }
+        
+        // Score based on pattern
+        int lineLength = playerCount + 1; // Include the position itself
+        
+        if (lineLength >= WIN_COUNT) {
+            return WIN_SCORE; // Winning move
+        }
+        
+        if (opponentCount == 0) { // No blocks
+            if (lineLength == 4) {
+                return (openEnds == 2) ? 50000 : 10000;
+            } else if (lineLength == 3) {
+                return (openEnds == 2) ? 5000 : 1000;
+            } else if (lineLength == 2) {
+                return (openEnds == 2) ? 500 : 100;
+            }
+        }
+        return 0;
+    }
+    
     // Thread pool for parallel evaluation (optional)
     static constexpr int THREAD_THRESHOLD = 50; // Use threads only for many moves
 
@@ -68,8 +117,9 @@ public:
         for (auto& row : board) {
             row.fill(0);
         }
-        occupiedPositions.clear();
-        consideredMoves.clear();
+        for (auto& rows : candidateRows) {
+            rows.fill(0);
+        }
         scoreCache = {};
         cacheValid = false;
     }
@@ -120,7 +170,7 @@ public:
 
         board[row][col] = currentPlayer;
         lastMove = {row, col};
-        occupiedPositions.push_back({row, col});
+        addCandidates(row, col);
         moveCount++;
         cacheValid = false; // Invalidate cache
 
@@ -137,6 +187,19 @@ public:
         return true;
     }
 
+    // O(radius^2) update of the candidate sets around a new stone
+    void addCandidates(int row, int col) {
+        for (int radius = 1; radius <= MAX_RADIUS; radius++) {
+            auto& rows = candidateRows[radius - 1];
+            for (int r = std::max(0, row - radius); r <= std::min(BOARD_SIZE - 1, row + radius); r++) {
+                for (int c = std::max(0, col - radius); c <= std::min(BOARD_SIZE - 1, col + radius); c++) {
+                    if (board[r][c] == 0) rows[r] |= 1 << c;
+                }
+            }
+            rows[row] &= ~(1 << col);
+        }
+    }
+
     // Optimized consecutive count using inline and avoiding repeated calculations
     inline int countLine(int row, int col, int dRow, int dCol, int player) const {
         int count = 1; // Count the current position
@@ -163,60 +226,34 @@ public:
         return count;
     }
 
-    // Fast evaluation using pattern matching
+    // Packed cells around (row, col) in one direction, see patterns.h
+    int lineKey(int row, int col, int dRow, int dCol, int player) const {
+        int key = 0;
+        for (int i = 0; i < LinePatterns::NEIGHBOURS; i++) {
+            int r = row + LinePatterns::offset(i) * dRow;
+            int c = col + LinePatterns::offset(i) * dCol;
+            int cell = LinePatterns::EDGE;
+            if (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE) {
+                cell = board[r][c] == 0 ? LinePatterns::EMPTY
+                     : board[r][c] == player ? LinePatterns::OWN : LinePatterns::OPPONENT;
+            }
+            key |= cell << (2 * i);
+        }
+        return key;
+    }
+
+    // Fast evaluation using precomputed line patterns
     int evaluatePositionFast(int row, int col, int player) const {
         if (!isValidMove(row, col)) return -1;
         
         int score = 0;
-        const int opponent = 3 - player;
         
         for (const auto& dir : DIRECTIONS) {
-            int playerCount = 0, opponentCount = 0;
-            int openEnds = 0;
-            
-            // Check line in both directions from the position
-            for (int sign = -1; sign <= 1; sign += 2) {
-                int r = row + sign * dir[0];
-                int c = col + sign * dir[1];
-                int consecutive = 0;
-                
-                while (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE) {
-                    if (board[r][c] == player) {
-                        playerCount++;
-                        consecutive++;
-                    } else if (board[r][c] == opponent) {
-                        opponentCount++;
-                        break;
-                    } else {
-                        if (consecutive > 0) openEnds++;
-                        break;
-                    }
-                    r += sign * dir[0];
-                    c += sign * dir[1];
-                }
-                
-                // Check if line extends to edge
-                if (!(r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE)) {
-                    if (consecutive == 0) openEnds++;
-                }
-            }
-            
-            // Score based on pattern
-            int lineLength = playerCount + 1; // Include the position itself
-            
-            if (lineLength >= WIN_COUNT) {
+            int lineScore = LINE_SCORES[lineKey(row, col, dir[0], dir[1], player)];
+            if (lineScore == WIN_SCORE) {
                 return WIN_SCORE; // Winning move
             }
-            
-            if (opponentCount == 0) { // No blocks
-                if (lineLength == 4) {
-                    score += (openEnds == 2) ? 50000 : 10000;
-                } else if (lineLength == 3) {
-                    score += (openEnds == 2) ? 5000 : 1000;
-                } else if (lineLength == 2) {
-                    score += (openEnds == 2) ? 500 : 100;
-                }
-            }
+            score += lineScore;
         }
         
         // Center preference with manhattan distance
@@ -236,43 +273,31 @@ public:
             return moves;
         }
         
-        // Use hash set for O(1) lookup of already considered positions
-        std::unordered_set<int> visited;
-        
-        // Generate moves around occupied positions
+        // Generate moves around occupied positions from the maintained set
         int searchRadius = (aiDifficulty == 3) ? 2 : 1;
+        const auto& rows = candidateRows[searchRadius - 1];
         
-        for (const auto& [occRow, occCol] : occupiedPositions) {
-            for (int di = -searchRadius; di <= searchRadius; di++) {
-                for (int dj = -searchRadius; dj <= searchRadius; dj++) {
-                    if (di == 0 && dj == 0) continue;
-                    
-                    int ni = occRow + di;
-                    int nj = occCol + dj;
-                    
-                    if (isValidMove(ni, nj)) {
-                        int hash = posToHash(ni, nj);
-                        if (visited.insert(hash).second) { // Returns true if newly inserted
-                            int opponent = 3 - player;
-                            int attackScore = evaluatePositionFast(ni, nj, player);
-                            int defenseScore = evaluatePositionFast(ni, nj, opponent);
-                            
-                            // Priority calculation based on difficulty
-                            double defenseWeight = (aiDifficulty == 1) ? 0.5 : 
-                                                 (aiDifficulty == 2) ? 0.9 : 1.1;
-                            int totalScore = attackScore + static_cast<int>(defenseScore * defenseWeight);
-                            
-                            // Immediate threats handling
-                            if (attackScore >= WIN_SCORE) {
-                                totalScore = WIN_SCORE + 1000;
-                            } else if (defenseScore >= WIN_SCORE) {
-                                totalScore = MUST_BLOCK_SCORE;
-                            }
-                            
-                            moves.emplace_back(ni, nj, totalScore);
-                        }
-                    }
+        for (int ni = 0; ni < BOARD_SIZE; ni++) {
+            for (int nj = 0, bits = rows[ni]; bits; nj++, bits >>= 1) {
+                if (!(bits & 1)) continue;
+                
+                int opponent = 3 - player;
+                int attackScore = evaluatePositionFast(ni, nj, player);
+                int defenseScore = evaluatePositionFast(ni, nj, opponent);
+                
+                // Priority calculation based on difficulty
+                double defenseWeight = (aiDifficulty == 1) ? 0.5 : 
+                                     (aiDifficulty == 2) ? 0.9 : 1.1;
+                int totalScore = attackScore + static_cast<int>(defenseScore * defenseWeight);
+                
+                // Immediate threats handling
+                if (attackScore >= WIN_SCORE) {
+                    totalScore = WIN_SCORE + 1000;
+                } else if (defenseScore >= WIN_SCORE) {
+                    totalScore = MUST_BLOCK_SCORE;
                 }
+                
+                moves.emplace_back(ni, nj, totalScore);
             }
         }
         
@@ -473,6 +498,8 @@ public:
     }
 };
 
+const std::array<int, LinePatterns::KEY_COUNT> Gomoku::LINE_SCORES = LinePatterns::build<int>(Gomoku::scoreLine);
+
 int main() {
     Gomoku game;
     char playAgain;
@@ -9,13 +9,18 @@
 #include <tuple>
 #include <string>
 #include <cctype>
+#include <cstdlib>
+#include <array>
+#include "patterns.h"
+#include "padded_board.h"
+#include "board_scorer.h"
 
 const int BOARD_SIZE = 15;
 const int WIN_LENGTH = 5;
 
 class Gomoku {
 private:
-    std::vector<std::vector<int>> board;
+    PaddedBoard board;
     int currentPlayer;
     int lastMoveRow, lastMoveCol;
     int winner;
@@ -23,7 +28,10 @@ private:
     int difficulty_ai1; // For AI vs AI mode
     int difficulty_ai2; // For AI vs AI mode
     int totalMoves;
+    bool headless; // Batch mode: no rendering, delays or per-game output
     std::mt19937 rng;
+    BoardScorer::Scores blackScores; // Line scores of every cell, see getAIMove
+    BoardScorer::Scores whiteScores;
     
     // Statistics
     int playerWins;
@@ -33,9 +41,42 @@ private:
     int ai2Wins; // For AI vs AI mode
     int aiDraws; // For AI vs AI mode
     
+    // Score of a stone's shape in one direction, indexed by line key
+    static const std::array<int, LinePatterns::KEY_COUNT> LINE_SCORES;
+    
+    static int scoreLine(const LinePatterns::Window& window) {
+        int count = LinePatterns::run(window);
+        int openEnds = (LinePatterns::pastRun(window, 1) == LinePatterns::EMPTY) +
+                       (LinePatterns::pastRun(window, -1) == LinePatterns::EMPTY);
+        
+        // Score based on count and openness
+        if (count >= 5) {
+            return 100000; // Winning move
+        } else if (count == 4) {
+            // Check if open on both ends
+            if (openEnds == 2) {
+                return 10000; // Open four
+            } else if (openEnds == 1) {
+                return 5000; // Semi-open four
+            }
+        } else if (count == 3) {
+            if (openEnds == 2) {
+                return 1000; // Open three
+            } else if (openEnds == 1) {
+                return 500; // Semi-open three
+            }
+        } else if (count == 2) {
+            if (openEnds == 2) {
+                return 100; // Open two
+            } else if (openEnds == 1) {
+                return 50; // Semi-open two
+            }
+        }
+        return 0;
+    }
+    
 public:
-    Gomoku() : board(BOARD_SIZE, std::vector<int>(BOARD_SIZE, 0)), 
-               currentPlayer(1), 
+    Gomoku() : currentPlayer(1), 
                lastMoveRow(-1), 
                lastMoveCol(-1),
                winner(0),
@@ -43,6 +84,7 @@ public:
                difficulty_ai1(2),
                difficulty_ai2(2),
                totalMoves(0),
+               headless(false),
                rng(std::chrono::steady_clock::now().time_since_epoch().count()),
                playerWins(0),
                aiWins(0),
@@ -52,6 +94,8 @@ public:
                aiDraws(0) {}
     
     void displayBoard() {
+        if (headless) return;
+        
         // Clear screen
         #ifdef _WIN32
             system("cls");
@@ -75,9 +119,9 @@ public:
                     std::cout << " ";
                 }
                 
-                if (board[i][j] == 0) {
+                if (board.at(i, j) == 0) {
                     std::cout << ".";
-                } else if (board[i][j] == 1) {
+                } else if (board.at(i, j) == 1) {
                     std::cout << "X";
                 } else {
                     std::cout << "O";
@@ -102,7 +146,7 @@ public:
     bool isValidMove(int row, int col) {
         return row >= 0 && row < BOARD_SIZE && 
                col >= 0 && col < BOARD_SIZE && 
-               board[row][col] == 0;
+               board.at(row, col) == 0;
     }
     
     bool makeMove(int row, int col, int player) {
@@ -110,7 +154,7 @@ public:
             return false;
         }
         
-        board[row][col] = player;
+        board.set(row, col, player);
         lastMoveRow = row;
         lastMoveCol = col;
         totalMoves++;
@@ -119,22 +163,11 @@ public:
     }
     
     int countConsecutive(int row, int col, int dRow, int dCol, int player) {
-        int count = 0;
-        int r = row + dRow;
-        int c = col + dCol;
-        
-        while (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && 
-               board[r][c] == player) {
-            count++;
-            r += dRow;
-            c += dCol;
-        }
-        
-        return count;
+        return board.countRun(PaddedBoard::index(row, col), PaddedBoard::step(dRow, dCol), player);
     }
     
     bool checkDirection(int row, int col, int dRow, int dCol) {
-        int player = board[row][col];
+        int player = board.at(row, col);
         if (player == 0) return false;
         
         int count = 1;
@@ -157,81 +190,24 @@ public:
     
     int evaluatePosition(int row, int col, int player) {
         int score = 0;
-        
-        board[row][col] = player; // Temporarily place piece
+        int cell = PaddedBoard::index(row, col);
         
         // Check all four directions
-        int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
-        
-        for (auto& dir : directions) {
-            int count = 1;
-            int openEnds = 0;
-            
-            // Count in positive direction
-            int r = row + dir[0];
-            int c = col + dir[1];
-            while (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && 
-                   board[r][c] == player) {
-                count++;
-                r += dir[0];
-                c += dir[1];
-            }
-            if (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && 
-                board[r][c] == 0) {
-                openEnds++;
-            }
-            
-            // Count in negative direction
-            r = row - dir[0];
-            c = col - dir[1];
-            while (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && 
-                   board[r][c] == player) {
-                count++;
-                r -= dir[0];
-                c -= dir[1];
-            }
-            if (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && 
-                board[r][c] == 0) {
-                openEnds++;
-            }
-            
-            // Score based on count and openness
-            if (count >= 5) {
-                score += 100000; // Winning move
-            } else if (count == 4) {
-                // Check if open on both ends
-                if (openEnds == 2) {
-                    score += 10000; // Open four
-                } else if (openEnds == 1) {
-                    score += 5000; // Semi-open four
-                }
-            } else if (count == 3) {
-                if (openEnds == 2) {
-                    score += 1000; // Open three
-                } else if (openEnds == 1) {
-                    score += 500; // Semi-open three
-                }
-            } else if (count == 2) {
-                if (openEnds == 2) {
-                    score += 100; // Open two
-                } else if (openEnds == 1) {
-                    score += 50; // Semi-open two
-                }
-            }
+        for (int step : PaddedBoard::DIRECTIONS) {
+            score += LINE_SCORES[board.lineKey(cell, step, player)];
         }
         
-        // Add positional bonus (center is better)
+        return score + centerBonus(row, col);
+    }
+    
+    // Positional bonus (center is better)
+    static int centerBonus(int row, int col) {
         int centerDistance = std::abs(row - BOARD_SIZE/2) + std::abs(col - BOARD_SIZE/2);
-        score += (BOARD_SIZE - centerDistance);
-        
-        board[row][col] = 0; // Remove temporary piece
-        
-        return score;
+        return BOARD_SIZE - centerDistance;
     }
     
     std::pair<int, int> getAIMove(int aiDifficulty = -1) {
         int player = currentPlayer;
-        int opponent = (player == 1) ? 2 : 1;
         int useDifficulty = (aiDifficulty == -1) ? difficulty : aiDifficulty;
         
         std::vector<std::tuple<int, int, int>> moves; // row, col, score
@@ -241,30 +217,24 @@ public:
             return {BOARD_SIZE/2, BOARD_SIZE/2};
         }
         
+        // Line scores of every cell for both players in one pass
+        BoardScorer::scoreAll(board, LINE_SCORES.data(), blackScores, whiteScores);
+        const BoardScorer::Scores& ownScores = (player == 1) ? blackScores : whiteScores;
+        const BoardScorer::Scores& opponentScores = (player == 1) ? whiteScores : blackScores;
+        
         // Consider moves near existing pieces
         for (int i = 0; i < BOARD_SIZE; i++) {
             for (int j = 0; j < BOARD_SIZE; j++) {
-                if (board[i][j] != 0) continue;
+                if (board.at(i, j) != 0) continue;
                 
                 // Check if there's a piece nearby
-                bool hasNeighbor = false;
                 int searchRadius = (useDifficulty == 3) ? 2 : 1; // Harder AI looks further
-                
-                for (int di = -searchRadius; di <= searchRadius && !hasNeighbor; di++) {
-                    for (int dj = -searchRadius; dj <= searchRadius && !hasNeighbor; dj++) {
-                        if (di == 0 && dj == 0) continue;
-                        int ni = i + di;
-                        int nj = j + dj;
-                        if (ni >= 0 && ni < BOARD_SIZE && nj >= 0 && nj < BOARD_SIZE && 
-                            board[ni][nj] != 0) {
-                            hasNeighbor = true;
-                        }
-                    }
-                }
+                bool hasNeighbor = board.hasNeighbour(i, j, searchRadius);
                 
                 if (hasNeighbor) {
-                    int attackScore = evaluatePosition(i, j, player); // AI's move
-                    int defenseScore = evaluatePosition(i, j, opponent); // Block opponent
+                    int cell = PaddedBoard::index(i, j);
+                    int attackScore = ownScores[cell] + centerBonus(i, j); // AI's move
+                    int defenseScore = opponentScores[cell] + centerBonus(i, j); // Block opponent
                     
                     // Adjust weights based on difficulty
                     float attackWeight = 1.0;
@@ -354,6 +324,12 @@ public:
     }
     
     void playAITurn(const std::string& aiName = "AI", int aiDifficulty = -1) {
+        if (headless) {
+            auto [row, col] = getAIMove(aiDifficulty);
+            makeMove(row, col, currentPlayer);
+            return;
+        }
+        
         std::cout << aiName << " is thinking";
         
         int delay = 500; // Default fast
@@ -448,7 +424,7 @@ public:
     }
     
     void resetBoard() {
-        board = std::vector<std::vector<int>>(BOARD_SIZE, std::vector<int>(BOARD_SIZE, 0));
+        board.clear();
         currentPlayer = 1;
         lastMoveRow = -1;
         lastMoveCol = -1;
@@ -460,11 +436,13 @@ public:
         resetBoard();
         bool gameOver = false;
         
-        std::cout << "\n=== AI vs AI Match ===\n";
-        std::cout << "AI 1 (X): " << getDifficultyName(difficulty_ai1) << "\n";
-        std::cout << "AI 2 (O): " << getDifficultyName(difficulty_ai2) << "\n";
-        std::cout << "Starting in 2 seconds...\n\n";
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+        if (!headless) {
+            std::cout << "\n=== AI vs AI Match ===\n";
+            std::cout << "AI 1 (X): " << getDifficultyName(difficulty_ai1) << "\n";
+            std::cout << "AI 2 (O): " << getDifficultyName(difficulty_ai2) << "\n";
+            std::cout << "Starting in 2 seconds...\n\n";
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+        }
         
         while (!gameOver) {
             displayBoard();
@@ -485,24 +463,45 @@ public:
             }
         }
         
+        if (winner == 0) {
+            aiDraws++;
+        } else if (winner == 1) {
+            ai1Wins++;
+        } else {
+            ai2Wins++;
+        }
+        if (headless) return;
+        
         displayBoard();
         
         if (winner == 0) {
             std::cout << "\n=== Game Over: Draw! ===\n";
-            aiDraws++;
         } else {
             std::cout << "\n=== Game Over: AI " << winner;
             std::cout << " (" << (winner == 1 ? "X" : "O") << ") Wins! ===\n";
-            if (winner == 1) {
-                ai1Wins++;
-            } else {
-                ai2Wins++;
-            }
         }
         
         showStatistics();
     }
     
+    // Plays AI vs AI games back to back without rendering or delays and
+    // prints only the totals
+    void runBatch(int games) {
+        headless = true;
+        for (int i = 0; i < games; i++) {
+            playAIvsAI();
+        }
+        headless = false;
+        
+        int total = ai1Wins + ai2Wins + aiDraws;
+        std::cout << "AI 1 (X) " << getDifficultyName(difficulty_ai1)
+                  << " vs AI 2 (O) " << getDifficultyName(difficulty_ai2) << "\n";
+        std::cout << "AI 1 (X) Wins: " << ai1Wins << "\n";
+        std::cout << "AI 2 (O) Wins: " << ai2Wins << "\n";
+        std::cout << "Draws: " << aiDraws << "\n";
+        std::cout << "Total: " << total << "\n";
+    }
+    
     void playGame(bool vsAI = true) {
         resetBoard();
         bool gameOver = false;
@@ -622,8 +621,36 @@ public:
     }
 };
 
-int main() {
+const std::array<int, LinePatterns::KEY_COUNT> Gomoku::LINE_SCORES = LinePatterns::build<int>(Gomoku::scoreLine);
+
+// Usage: gmk-ai-ai-v3 [--batch <games>] [--ai1 <1-3>] [--ai2 <1-3>]
+// --batch plays AI vs AI games headless and prints only the statistics
+int main(int argc, char* argv[]) {
+    int batchGames = 0;
+    int diff1 = 2, diff2 = 2;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        int* value = (arg == "--batch") ? &batchGames
+                   : (arg == "--ai1") ? &diff1
+                   : (arg == "--ai2") ? &diff2 : nullptr;
+        bool valid = value != nullptr && i + 1 < argc;
+        if (valid) {
+            *value = std::atoi(argv[++i]);
+            valid = value == &batchGames ? *value > 0 : *value >= 1 && *value <= 3;
+        }
+        if (!valid) {
+            std::cerr << "Usage: " << argv[0] << " [--batch <games>] [--ai1 <1-3>] [--ai2 <1-3>]\n";
+            return 1;
+        }
+    }
+    
     Gomoku game;
-    game.run();
+    game.setAIDifficulties(diff1, diff2);
+    if (batchGames > 0) {
+        game.runBatch(batchGames);
+    } else {
+        game.run();
+    }
     return 0;
 }
@@ -7,12 +7,15 @@
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <array>
+#include "padded_board.h"
+#include "board_scorer.h"
 
 class Gomoku {
 private:
     static const int BOARD_SIZE = 15;
     static const int WIN_COUNT = 5;
-    std::vector<std::vector<int>> board;
+    PaddedBoard board;
     int currentPlayer;
     bool gameOver;
     int winner;
@@ -23,15 +26,33 @@ private:
     int ai1Difficulty;
     int ai2Difficulty;
     std::pair<int, int> lastMove;
+    BoardScorer::Scores blackScores;  // line scores of every cell, see findBestMove
+    BoardScorer::Scores whiteScores;
 
     struct Move {
         int row, col, score;
         Move(int r = -1, int c = -1, int s = 0) : row(r), col(c), score(s) {}
     };
 
+    // Score of a stone's shape in one direction, indexed by line key
+    static const std::array<int, LinePatterns::KEY_COUNT> LINE_SCORES;
+
+    static int scoreLine(const LinePatterns::Window& window) {
+        int count = LinePatterns::run(window);
+        if (count >= WIN_COUNT) return 100000; // Winning move
+        if (count == 4) {
+            // Check if open on both ends
+            bool open1 = LinePatterns::pastRun(window, 1) == LinePatterns::EMPTY;
+            bool open2 = LinePatterns::pastRun(window, -1) == LinePatterns::EMPTY;
+            return (open1 && open2) ? 10000 : 5000; // Open four, semi-open four
+        }
+        if (count == 3) return 1000;
+        if (count == 2) return 100;
+        return 0;
+    }
+
 public:
-    Gomoku() : board(BOARD_SIZE, std::vector<int>(BOARD_SIZE, 0)), 
-               currentPlayer(1), gameOver(false), winner(0), moveCount(0),
+    Gomoku() : currentPlayer(1), gameOver(false), winner(0), moveCount(0),
                vsAI(false), aiVsAI(false), aiDifficulty(2), 
                ai1Difficulty(2), ai2Difficulty(2), lastMove(-1, -1) {
         std::srand(std::time(nullptr));
@@ -52,8 +73,8 @@ public:
             std::cout << std::setw(2) << i << "|";
             for (int j = 0; j < BOARD_SIZE; j++) {
                 char symbol = '.';
-                if (board[i][j] == 1) symbol = 'X';
-                else if (board[i][j] == 2) symbol = 'O';
+                if (board.at(i, j) == 1) symbol = 'X';
+                else if (board.at(i, j) == 2) symbol = 'O';
                 
                 // Highlight last move
                 if (i == lastMove.first && j == lastMove.second && moveCount > 0) {
@@ -70,7 +91,7 @@ public:
     bool isValidMove(int row, int col) {
         return row >= 0 && row < BOARD_SIZE && 
                col >= 0 && col < BOARD_SIZE && 
-               board[row][col] == 0;
+               board.at(row, col) == 0;
     }
 
     bool makeMove(int row, int col) {
@@ -78,7 +99,7 @@ public:
             return false;
         }
 
-        board[row][col] = currentPlayer;
+        board.set(row, col, currentPlayer);
         lastMove = {row, col};
         moveCount++;
 
@@ -96,64 +117,13 @@ public:
     }
 
     int countConsecutive(int row, int col, int dRow, int dCol, int player) {
-        int count = 0;
-        int r = row + dRow;
-        int c = col + dCol;
-        
-        while (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && 
-               board[r][c] == player) {
-            count++;
-            r += dRow;
-            c += dCol;
-        }
-        
-        return count;
+        return board.countRun(PaddedBoard::index(row, col), PaddedBoard::step(dRow, dCol), player);
     }
 
-    int evaluatePosition(int row, int col, int player) {
-        if (!isValidMove(row, col)) return -1;
-        
-        int score = 0;
-        board[row][col] = player; // Temporarily place piece
-        
-        // Check all four directions
-        int directions[4][2] = {{0,1}, {1,0}, {1,1}, {1,-1}};
-        
-        for (auto& dir : directions) {
-            int count = 1;
-            count += countConsecutive(row, col, dir[0], dir[1], player);
-            count += countConsecutive(row, col, -dir[0], -dir[1], player);
-            
-            if (count >= WIN_COUNT) {
-                score += 100000; // Winning move
-            } else if (count == 4) {
-                // Check if open on both ends
-                int r1 = row + (count - countConsecutive(row, col, -dir[0], -dir[1], player)) * dir[0];
-                int c1 = col + (count - countConsecutive(row, col, -dir[0], -dir[1], player)) * dir[1];
-                int r2 = row - (countConsecutive(row, col, -dir[0], -dir[1], player) + 1) * dir[0];
-                int c2 = col - (countConsecutive(row, col, -dir[0], -dir[1], player) + 1) * dir[1];
-                
-                bool open1 = (r1 >= 0 && r1 < BOARD_SIZE && c1 >= 0 && c1 < BOARD_SIZE && board[r1][c1] == 0);
-                bool open2 = (r2 >= 0 && r2 < BOARD_SIZE && c2 >= 0 && c2 < BOARD_SIZE && board[r2][c2] == 0);
-                
-                if (open1 && open2) {
-                    score += 10000; // Open four
-                } else {
-                    score += 5000; // Semi-open four
-                }
-            } else if (count == 3) {
-                score += 1000;
-            } else if (count == 2) {
-                score += 100;
-            }
-        }
-        
-        // Add positional bonus (center is better)
+    // Positional bonus (center is better)
+    static int centerBonus(int row, int col) {
         int centerDist = std::abs(row - BOARD_SIZE/2) + std::abs(col - BOARD_SIZE/2);
-        score += (BOARD_SIZE - centerDist) * 10;
-        
-        board[row][col] = 0; // Remove temporary piece
-        return score;
+        return (BOARD_SIZE - centerDist) * 10;
     }
 
     Move findBestMove(int difficulty, int player) {
@@ -164,31 +134,24 @@ public:
             return Move(BOARD_SIZE/2, BOARD_SIZE/2, 0);
         }
         
+        // Line scores of every cell for both players in one pass
+        BoardScorer::scoreAll(board, LINE_SCORES.data(), blackScores, whiteScores);
+        const BoardScorer::Scores& ownScores = (player == 1) ? blackScores : whiteScores;
+        const BoardScorer::Scores& opponentScores = (player == 1) ? whiteScores : blackScores;
+        
         // Consider moves near existing pieces
         for (int i = 0; i < BOARD_SIZE; i++) {
             for (int j = 0; j < BOARD_SIZE; j++) {
-                if (board[i][j] != 0) continue;
+                if (board.at(i, j) != 0) continue;
                 
                 // Check if there's a piece nearby
-                bool hasNeighbor = false;
                 int searchRadius = (difficulty == 3) ? 2 : 1; // Harder AI looks further
-                
-                for (int di = -searchRadius; di <= searchRadius && !hasNeighbor; di++) {
-                    for (int dj = -searchRadius; dj <= searchRadius; dj++) {
-                        if (di == 0 && dj == 0) continue;
-                        int ni = i + di, nj = j + dj;
-                        if (ni >= 0 && ni < BOARD_SIZE && nj >= 0 && nj < BOARD_SIZE && 
-                            board[ni][nj] != 0) {
-                            hasNeighbor = true;
-                            break;
-                        }
-                    }
-                }
+                bool hasNeighbor = board.hasNeighbour(i, j, searchRadius);
                 
                 if (hasNeighbor) {
-                    int opponent = (player == 1) ? 2 : 1;
-                    int attackScore = evaluatePosition(i, j, player); // AI's move
-                    int defenseScore = evaluatePosition(i, j, opponent); // Block opponent
+                    int cell = PaddedBoard::index(i, j);
+                    int attackScore = ownScores[cell] + centerBonus(i, j); // AI's move
+                    int defenseScore = opponentScores[cell] + centerBonus(i, j); // Block opponent
                     
                     // Adjust weights based on difficulty
                     double defenseWeight = (difficulty == 1) ? 0.5 : (difficulty == 2) ? 0.9 : 1.1;
@@ -247,7 +210,7 @@ public:
 
     bool checkDirection(int row, int col, int dRow, int dCol) {
         int count = 1;
-        int player = board[row][col];
+        int player = board.at(row, col);
 
         count += countConsecutive(row, col, dRow, dCol, player);
         count += countConsecutive(row, col, -dRow, -dCol, player);
@@ -413,11 +376,7 @@ public:
     }
 
     void reset() {
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                board[i][j] = 0;
-            }
-        }
+        board.clear();
         currentPlayer = 1;
         gameOver = false;
         winner = 0;
@@ -427,6 +386,8 @@ public:
     }
 };
 
+const std::array<int, LinePatterns::KEY_COUNT> Gomoku::LINE_SCORES = LinePatterns::build<int>(Gomoku::scoreLine);
+
 int main() {
     Gomoku game;
     char playAgain;
@@ -0,0 +1,231 @@
+// Searches a fixed set of positions to a fixed depth with each engine
+// variant and reports the work done as JSON, so engine changes can be
+// compared run to run.
+//
+// The variants are one thread with the default search, one thread without
+// each part of selective search (late move reductions, null moves and
+// futility pruning) in turn and without any, without threat extensions,
+// without quiescence and with threes in quiescence, and Lazy SMP.
+//
+// Every search starts from a cleared engine with a fixed seed. The
+// single-threaded variant therefore reports the same nodes and moves on
+// every run, and its node counts gate search changes. Times and
+// nodes/second gate speed changes. Lazy SMP timings vary with scheduling.
+//
+// Per position the report gives the best move, score, completed depth,
+// nodes, time, nodes/second, transposition table hit rate and the time at
+// which each iteration completed. Totals follow per variant. A libgomoku
+// built with GOMOKU_STATS adds each search's profile.
+//
+// Usage: gmk-bench [--depth <plies>] [--hash <MB>] [--threads <n>] [-o <file>]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+
+#include "engine.h"
+
+using namespace gomoku;
+
+struct BenchPosition {
+    const char* name;
+    const char* moves;  // row,col pairs from the first move, as in game records
+};
+
+// Openings to the middle game from self-play, plus a corner fight; none of
+// them is settled by an immediate five or the threat solver
+const BenchPosition POSITIONS[] = {
+    {"opening-1", "7,7"},
+    {"opening-3", "7,7 5,7 6,7"},
+    {"opening-4", "7,7 7,5 8,6 9,5"},
+    {"early-7", "7,7 7,5 7,6 8,6 9,7 6,5 6,7"},
+    {"early-11", "7,7 7,5 7,6 8,6 9,7 6,5 6,7 5,7 10,7 8,7 8,5"},
+    {"middle-12", "7,7 7,5 8,6 9,5 6,6 5,5 6,7 5,7 8,5 5,6 5,8 7,6"},
+    {"middle-15", "7,7 7,5 7,6 8,6 9,7 6,5 6,7 5,7 10,7 8,7 8,5 9,4 5,8 4,9 6,6"},
+    {"middle-16", "7,7 7,5 8,6 9,5 6,6 5,5 6,7 5,7 8,5 5,6 5,8 7,6 8,8 8,7 9,9 10,10"},
+    {"middle-20", "7,7 7,5 8,6 9,5 6,6 5,5 6,7 5,7 8,5 5,6 5,8 7,6 8,8 8,7 9,9 10,10 6,5 6,8 7,9 6,4"},
+    {"corner-6", "0,0 1,1 0,1 2,2 0,3 3,3"},
+};
+
+struct BenchVariant {
+    std::string name;
+    SearchLimits limits;
+};
+
+struct Totals {
+    long long nodes = 0;
+    long long ttProbes = 0;
+    long long ttHits = 0;
+    std::chrono::microseconds time{0};
+};
+
+bool parsePosition(const char* moves, Board& board) {
+    std::istringstream in(moves);
+    std::string token;
+    while (in >> token) {
+        int row, col;
+        char comma;
+        std::istringstream move(token);
+        if (!(move >> row >> comma >> col) || comma != ',' ||
+            !board.placeStone(row, col, board.sideToMove())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double perSecond(long long count, std::chrono::microseconds time) {
+    return time.count() > 0 ? count * 1e6 / time.count() : 0.0;
+}
+
+double milliseconds(std::chrono::microseconds time) { return time.count() / 1000.0; }
+
+double hitRate(long long hits, long long probes) { return probes > 0 ? static_cast<double>(hits) / probes : 0.0; }
+
+const char* sourceName(SearchResult::Source source) {
+    switch (source) {
+        case SearchResult::Source::IMMEDIATE: return "immediate";
+        case SearchResult::Source::BOOK: return "book";
+        case SearchResult::Source::FORCED_WIN: return "forced_win";
+        default: return "search";
+    }
+}
+
+void writePosition(std::ostream& out, const BenchPosition& position, const SearchResult& result,
+                   std::chrono::microseconds time) {
+    out << "        {\"name\": \"" << position.name << "\", \"source\": \"" << sourceName(result.source) << "\""
+        << ", \"best\": [" << result.move.row << ", " << result.move.col << "]"
+        << ", \"score\": " << result.score << ", \"depth\": " << result.depth
+        << ", \"nodes\": " << result.nodes << ", \"time_ms\": " << milliseconds(time)
+        << ", \"nps\": " << static_cast<long long>(perSecond(result.nodes, time))
+        << ", \"tt_hit_rate\": " << hitRate(result.ttHits, result.ttProbes)
+        << ", \"time_to_depth_ms\": [";
+    for (size_t i = 0; i < result.iterations.size(); i++) {
+        const auto& iteration = result.iterations[i];
+        out << (i ? ", " : "") << "{\"depth\": " << iteration.depth << ", \"time_ms\": " << milliseconds(iteration.elapsed)
+            << ", \"nodes\": " << iteration.nodes << "}";
+    }
+    out << "]";
+    if (result.stats.enabled) {
+        const SearchStats& stats = result.stats;
+        out << ", \"stats\": {\"leaf_evaluations\": " << stats.leafEvaluations
+            << ", \"move_generations\": " << stats.moveGenerations << ", \"cutoffs_by_move\": [";
+        for (int i = 0; i < SearchStats::CUTOFF_SLOTS; i++) {
+            out << (i ? ", " : "") << stats.cutoffsByMove[i];
+        }
+        out << "], \"phase_time_ms\": {\"move_generation\": " << milliseconds(stats.phaseTime[SearchStats::MOVE_GENERATION])
+            << ", \"move_ordering\": " << milliseconds(stats.phaseTime[SearchStats::MOVE_ORDERING])
+            << ", \"evaluation\": " << milliseconds(stats.phaseTime[SearchStats::EVALUATION])
+            << ", \"threat_solver\": " << milliseconds(stats.phaseTime[SearchStats::THREAT_SOLVER]) << "}}";
+    }
+    out << "}";
+}
+
+int main(int argc, char* argv[]) {
+    int depth = MAX_DEPTH;
+    int hashMegabytes = 16;
+    int smpThreads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    std::string outputPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--depth") {
+            depth = std::max(1, std::atoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--hash") {
+            hashMegabytes = std::max(1, std::atoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--threads") {
+            smpThreads = std::max(2, std::atoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "-o") {
+            outputPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--depth <plies>] [--hash <MB>] [--threads <n>] [-o <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Single-threaded with the default search, then without each part of
+    // selective search in turn and without any, without threat extensions,
+    // without quiescence and with threes in quiescence, then Lazy SMP
+    std::vector<BenchVariant> variants(9);
+    variants[0].name = "single";
+    variants[1].name = "no-lmr";
+    variants[1].limits.lateMoveReductions = false;
+    variants[2].name = "no-null-move";
+    variants[2].limits.nullMove = false;
+    variants[3].name = "no-futility";
+    variants[3].limits.futility = false;
+    variants[4].name = "full-width";
+    variants[4].limits.lateMoveReductions = false;
+    variants[4].limits.nullMove = false;
+    variants[4].limits.futility = false;
+    variants[5].name = "no-extensions";
+    variants[5].limits.threatExtensions = false;
+    variants[6].name = "no-quiescence";
+    variants[6].limits.quiescence = false;
+    variants[7].name = "quiescence-threes";
+    variants[7].limits.quiescenceThrees = true;
+    variants[8].name = "lazy-smp";
+    variants[8].limits.threads = smpThreads;
+    for (auto& variant : variants) {
+        variant.limits.depth = depth;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file) {
+            std::cerr << "Cannot write " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+
+    out << "{\n  \"depth\": " << depth << ",\n  \"hash_mb\": " << hashMegabytes << ",\n  \"variants\": [\n";
+    Engine engine(hashMegabytes);
+    for (size_t v = 0; v < variants.size(); v++) {
+        const BenchVariant& variant = variants[v];
+        out << "    {\"name\": \"" << variant.name << "\", \"threads\": " << variant.limits.threads
+            << ", \"lmr\": " << (variant.limits.lateMoveReductions ? "true" : "false")
+            << ", \"null_move\": " << (variant.limits.nullMove ? "true" : "false")
+            << ", \"futility\": " << (variant.limits.futility ? "true" : "false")
+            << ", \"extensions\": " << (variant.limits.threatExtensions ? "true" : "false")
+            << ", \"quiescence\": "
+            << (!variant.limits.quiescence ? "\"off\"" : variant.limits.quiescenceThrees ? "\"threes\"" : "\"fours\"")
+            << ", \"positions\": [\n";
+
+        Totals totals;
+        for (size_t p = 0; p < std::size(POSITIONS); p++) {
+            Board board;
+            if (!parsePosition(POSITIONS[p].moves, board)) {
+                std::cerr << "Bad bench position " << POSITIONS[p].name << std::endl;
+                return 1;
+            }
+            engine.clear();
+            engine.setSeed(static_cast<uint32_t>(p + 1));
+
+            auto start = std::chrono::steady_clock::now();
+            SearchResult result = engine.search(board, variant.limits);
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+            totals.nodes += result.nodes;
+            totals.ttProbes += result.ttProbes;
+            totals.ttHits += result.ttHits;
+            totals.time += time;
+            writePosition(out, POSITIONS[p], result, time);
+            out << (p + 1 < std::size(POSITIONS) ? ",\n" : "\n");
+        }
+
+        out << "      ], \"total\": {\"nodes\": " << totals.nodes << ", \"time_ms\": " << milliseconds(totals.time)
+            << ", \"nps\": " << static_cast<long long>(perSecond(totals.nodes, totals.time))
+            << ", \"tt_hit_rate\": " << hitRate(totals.ttHits, totals.ttProbes) << "}}"
+            << (v + 1 < variants.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}" << std::endl;
+    return 0;
+}
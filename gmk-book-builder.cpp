@@ -0,0 +1,160 @@
+// Builds an opening book (see opening_book.h) from self-play game records.
+//
+// Each input line is one game: the result (B, W or D) followed by its moves
+// as row,col pairs, the format written by the opus engine's --record flag.
+// Every position within the first --plies moves, in all eight board
+// symmetries, gets an entry for the move played from it. The weight scores
+// how the games through that move ended for the side that played it: two
+// points per win, one per draw.
+//
+// Usage: gmk-book-builder -o <book> [--plies <n>] [--min-games <n>] <records>...
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "zobrist.h"
+#include "opening_book.h"
+
+constexpr int BOARD_SIZE = 15;
+constexpr int SYMMETRIES = 8;
+
+struct MoveStats {
+    int games = 0;
+    int points = 0;  // 2 per win, 1 per draw
+};
+
+struct GameRecord {
+    char result;  // 'B', 'W' or 'D'
+    std::vector<std::pair<int, int>> moves;
+};
+
+// Cell index of (row, col) under one of the eight rotations and reflections
+int transform(int row, int col, int symmetry) {
+    if (symmetry & 4) std::swap(row, col);
+    if (symmetry & 1) row = BOARD_SIZE - 1 - row;
+    if (symmetry & 2) col = BOARD_SIZE - 1 - col;
+    return row * BOARD_SIZE + col;
+}
+
+bool parseRecord(const std::string& line, GameRecord& record) {
+    std::istringstream in(line);
+    std::string token;
+    if (!(in >> token) || token.size() != 1 || std::string("BWD").find(token[0]) == std::string::npos) {
+        return false;
+    }
+    record.result = token[0];
+    record.moves.clear();
+    while (in >> token) {
+        int row, col;
+        char comma;
+        std::istringstream move(token);
+        if (!(move >> row >> comma >> col) || comma != ',' ||
+            row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE) {
+            return false;
+        }
+        record.moves.emplace_back(row, col);
+    }
+    return true;
+}
+
+void addGame(const GameRecord& game, int plies, std::map<std::pair<uint64_t, int>, MoveStats>& stats) {
+    uint64_t keys[SYMMETRIES] = {};
+    int limit = std::min<int>(plies, static_cast<int>(game.moves.size()));
+
+    for (int ply = 0; ply < limit; ply++) {
+        int color = ply % 2;  // black moves first
+        char mover = color == 0 ? 'B' : 'W';
+        int points = game.result == mover ? 2 : (game.result == 'D' ? 1 : 0);
+        auto [row, col] = game.moves[ply];
+
+        // Symmetric positions can coincide (the empty board, for one);
+        // count each position/move pair once per game
+        std::vector<std::pair<uint64_t, int>> seen;
+        for (int s = 0; s < SYMMETRIES; s++) {
+            std::pair<uint64_t, int> entry(keys[s], transform(row, col, s));
+            if (std::find(seen.begin(), seen.end(), entry) == seen.end()) {
+                seen.push_back(entry);
+                MoveStats& moveStats = stats[entry];
+                moveStats.games++;
+                moveStats.points += points;
+            }
+            keys[s] ^= Zobrist::stone(color, transform(row, col, s));
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string output;
+    int plies = 14;
+    int minGames = 1;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--plies" && i + 1 < argc) {
+            plies = std::atoi(argv[++i]);
+        } else if (arg == "--min-games" && i + 1 < argc) {
+            minGames = std::max(1, std::atoi(argv[++i]));
+        } else if (!arg.empty() && arg[0] != '-') {
+            inputs.push_back(arg);
+        } else {
+            inputs.clear();
+            break;
+        }
+    }
+    if (output.empty() || inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " -o <book> [--plies <n>] [--min-games <n>] <records>..." << std::endl;
+        return 1;
+    }
+
+    std::map<std::pair<uint64_t, int>, MoveStats> stats;
+    int games = 0;
+    for (const auto& path : inputs) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Cannot read " << path << std::endl;
+            return 1;
+        }
+        std::string line;
+        int lineNumber = 0;
+        GameRecord record;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (line.empty()) continue;
+            if (!parseRecord(line, record)) {
+                std::cerr << path << ":" << lineNumber << ": skipping malformed game record" << std::endl;
+                continue;
+            }
+            addGame(record, plies, stats);
+            games++;
+        }
+    }
+
+    // Moves that never scored are left out, so the book only suggests
+    // moves that have won or drawn
+    std::vector<OpeningBook::Entry> entries;
+    for (const auto& [position, moveStats] : stats) {
+        if (moveStats.games < minGames || moveStats.points == 0) continue;
+        OpeningBook::Entry entry = {};
+        entry.key = position.first;
+        entry.move = static_cast<uint16_t>(position.second);
+        entry.weight = static_cast<uint16_t>(std::min(moveStats.points, 0xFFFF));
+        entries.push_back(entry);
+    }
+
+    if (!OpeningBook::write(output, entries)) {
+        std::cerr << "Cannot write " << output << std::endl;
+        return 1;
+    }
+    std::cout << games << " games, " << entries.size() << " book entries written to " << output << std::endl;
+    return 0;
+}
@@ -1,492 +1,180 @@
 // gomoku.cpp - Production-quality Gomoku AI vs AI 
 //created by claude opus-4.1-08052025
+//
+// Console front-end over libgomoku: AI-vs-AI games, batch matches and
+// self-play records for the opening book builder.
 #include <iostream>
 #include <vector>
-#include <array>
 #include <algorithm>
 #include <chrono>
 #include <random>
 #include <limits>
-#include <memory>
-#include <unordered_map>
 #include <thread>
+#include <atomic>
 #include <iomanip>
+#include <cstdint>
+#include <string>
+#include <fstream>
 
-constexpr int BOARD_SIZE = 15;
-constexpr int WIN_LENGTH = 5;
-constexpr int MAX_DEPTH = 8;
-constexpr int INFINITY_SCORE = 1000000;
-constexpr int WIN_SCORE = 100000;
+#include "engine.h"
+#include "opening_book.h"
 
-enum class Stone { EMPTY = 0, BLACK = 1, WHITE = 2 };
-enum class GameStatus { ONGOING, BLACK_WIN, WHITE_WIN, DRAW };
+using namespace gomoku;
 
-// Direction vectors for checking lines
-const std::vector<std::pair<int, int>> DIRECTIONS = {
-    {0, 1},   // Horizontal
-    {1, 0},   // Vertical
-    {1, 1},   // Diagonal \
-    {1, -1}   // Diagonal /
-};
-
-// Pattern scores for evaluation
-struct PatternScore {
-    static constexpr int FIVE = 100000;
-    static constexpr int OPEN_FOUR = 10000;
-    static constexpr int BLOCKED_FOUR = 1000;
-    static constexpr int OPEN_THREE = 1000;
-    static constexpr int BLOCKED_THREE = 100;
-    static constexpr int OPEN_TWO = 100;
-    static constexpr int BLOCKED_TWO = 10;
-    static constexpr int ONE = 1;
-};
-
-class Position {
-public:
-    int row, col;
-    Position(int r = 0, int c = 0) : row(r), col(c) {}
-    bool isValid() const { 
-        return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE; 
-    }
-    bool operator==(const Position& other) const {
-        return row == other.row && col == other.col;
-    }
-};
-
-class Board {
-private:
-    std::array<std::array<Stone, BOARD_SIZE>, BOARD_SIZE> board;
-    std::vector<Position> moveHistory;
-    int moveCount;
-    
-public:
-    Board() : moveCount(0) {
-        for (auto& row : board) {
-            row.fill(Stone::EMPTY);
-        }
+void displayBoard(const Board& board) {
+    std::cout << "\n  ";
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        std::cout << std::setw(2) << i << " ";
     }
+    std::cout << "\n";
     
-    Stone getStone(int row, int col) const {
-        if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE) {
-            return Stone::EMPTY;
+    for (int r = 0; r < BOARD_SIZE; r++) {
+        std::cout << std::setw(2) << r << " ";
+        for (int c = 0; c < BOARD_SIZE; c++) {
+            char symbol = '.';
+            Stone stone = board.getStone(r, c);
+            if (stone == Stone::BLACK) symbol = 'X';
+            else if (stone == Stone::WHITE) symbol = 'O';
+            std::cout << symbol << "  ";
         }
-        return board[row][col];
+        std::cout << "\n";
     }
+    std::cout << "\n";
+}
+
+class Game {
+private:
+    Board board;
+    Engine blackAI;
+    Engine whiteAI;
+    GameStatus status;
+    int turnCount;
+    int blackDepth;
+    int whiteDepth;
+    size_t hashMegabytes;  // per engine
+    std::chrono::milliseconds moveTime;  // zero: search to the fixed depth
+    bool headless;  // no board rendering, delays or per-move/per-game output
+    const OpeningBook* book;
+    std::string recordPath;  // playMultipleGames appends its games here
     
-    bool placeStone(int row, int col, Stone stone) {
-        if (!isValidMove(row, col)) return false;
-        board[row][col] = stone;
-        moveHistory.push_back(Position(row, col));
-        moveCount++;
-        return true;
+    // A timed search deepens for as long as the budget allows
+    Position think(Engine& ai, const Board& position, int depth, bool verbose) const {
+        SearchLimits limits;
+        limits.depth = moveTime.count() > 0 ? MAX_PLY - 1 : depth;
+        limits.time = moveTime;
+        SearchResult result = ai.search(position, limits);
+        if (verbose) report(result, position.sideToMove());
+        return result.move;
     }
     
-    void removeStone(int row, int col) {
-        board[row][col] = Stone::EMPTY;
-        if (!moveHistory.empty()) {
-            moveHistory.pop_back();
-            moveCount--;
+    static void report(const SearchResult& result, Stone stone) {
+        std::string side = (stone == Stone::BLACK) ? "Black" : "White";
+        const Position& move = result.move;
+        switch (result.source) {
+            case SearchResult::Source::BOOK:
+                std::cout << "AI (" << side << ") plays book move (" << move.row << ", " << move.col << ")" << std::endl;
+                break;
+            case SearchResult::Source::FORCED_WIN:
+                std::cout << "AI (" << side << ") found a forced win in " << result.nodes << " nodes, plays ("
+                          << move.row << ", " << move.col << ")" << std::endl;
+                break;
+            case SearchResult::Source::SEARCH:
+                std::cout << "AI (" << side << ") thinks for " << result.elapsed.count() << "ms, "
+                          << "depth " << result.depth << ", nodes " << result.nodes
+                          << " (" << result.threads << (result.threads == 1 ? " thread" : " threads") << "), "
+                          << "best (" << move.row << ", " << move.col << "), "
+                          << "score: " << result.score << std::endl;
+                if (result.stats.enabled) reportStats(result.stats);
+                break;
+            default:
+                break;
         }
     }
     
-    bool isValidMove(int row, int col) const {
-        return row >= 0 && row < BOARD_SIZE && 
-               col >= 0 && col < BOARD_SIZE && 
-               board[row][col] == Stone::EMPTY;
-    }
-    
-    bool isFull() const {
-        return moveCount >= BOARD_SIZE * BOARD_SIZE;
-    }
-    
-    std::vector<Position> getEmptyPositions() const {
-        std::vector<Position> empty;
-        for (int r = 0; r < BOARD_SIZE; r++) {
-            for (int c = 0; c < BOARD_SIZE; c++) {
-                if (board[r][c] == Stone::EMPTY) {
-                    empty.emplace_back(r, c);
-                }
-            }
+    // Profile of a search, in libgomoku builds with GOMOKU_STATS
+    static void reportStats(const SearchStats& stats) {
+        auto ms = [](std::chrono::microseconds time) { return time.count() / 1000.0; };
+        std::cout << "  leaves " << stats.leafEvaluations << ", move generations " << stats.moveGenerations
+                  << ", cutoffs by move";
+        for (long long cutoffs : stats.cutoffsByMove) {
+            std::cout << " " << cutoffs;
         }
-        return empty;
+        std::cout << std::fixed << std::setprecision(1)
+                  << "\n  time: generation " << ms(stats.phaseTime[SearchStats::MOVE_GENERATION])
+                  << "ms, ordering " << ms(stats.phaseTime[SearchStats::MOVE_ORDERING])
+                  << "ms, evaluation " << ms(stats.phaseTime[SearchStats::EVALUATION])
+                  << "ms, threat solver " << ms(stats.phaseTime[SearchStats::THREAT_SOLVER]) << "ms"
+                  << std::defaultfloat << std::endl;
     }
     
-    std::vector<Position> getRelevantMoves(int range = 2) const {
-        std::vector<Position> moves;
-        std::vector<std::vector<bool>> considered(BOARD_SIZE, std::vector<bool>(BOARD_SIZE, false));
-        
-        // If board is empty, start from center
-        if (moveCount == 0) {
-            moves.emplace_back(BOARD_SIZE / 2, BOARD_SIZE / 2);
-            return moves;
+    // Plays one silent game on its own board between fresh engines seeded
+    // from seed; safe to run on several threads at once
+    GameStatus playIndependentGame(uint32_t seed, std::vector<Position>& history) const {
+        Board gameBoard;
+        Engine black(hashMegabytes);
+        Engine white(hashMegabytes);
+        std::mt19937 gameRng(seed);
+        black.setSeed(gameRng());
+        white.setSeed(gameRng());
+        black.setOpeningBook(book);
+        white.setOpeningBook(book);
+        
+        GameStatus result = GameStatus::ONGOING;
+        int moves = 0;
+        while (result == GameStatus::ONGOING) {
+            moves++;
+            Stone currentStone = (moves % 2 == 1) ? Stone::BLACK : Stone::WHITE;
+            Position move = currentStone == Stone::BLACK ? think(black, gameBoard, blackDepth, false)
+                                                         : think(white, gameBoard, whiteDepth, false);
+            gameBoard.placeStone(move.row, move.col, currentStone);
+            result = gameBoard.checkWin();
         }
-        
-        // Get positions near existing stones
-        for (int r = 0; r < BOARD_SIZE; r++) {
-            for (int c = 0; c < BOARD_SIZE; c++) {
-                if (board[r][c] != Stone::EMPTY) {
-                    for (int dr = -range; dr <= range; dr++) {
-                        for (int dc = -range; dc <= range; dc++) {
-                            int nr = r + dr;
-                            int nc = c + dc;
-                            if (isValidMove(nr, nc) && !considered[nr][nc]) {
-                                moves.emplace_back(nr, nc);
-                                considered[nr][nc] = true;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        
-        return moves;
+        history = gameBoard.getMoveHistory();
+        return result;
     }
     
-    GameStatus checkWin() const {
-        // Check for five in a row
-        for (int r = 0; r < BOARD_SIZE; r++) {
-            for (int c = 0; c < BOARD_SIZE; c++) {
-                Stone stone = board[r][c];
-                if (stone == Stone::EMPTY) continue;
-                
-                for (const auto& [dr, dc] : DIRECTIONS) {
-                    int count = 1;
-                    
-                    // Check positive direction
-                    for (int i = 1; i < WIN_LENGTH; i++) {
-                        int nr = r + dr * i;
-                        int nc = c + dc * i;
-                        if (getStone(nr, nc) != stone) break;
-                        count++;
-                    }
-                    
-                    if (count >= WIN_LENGTH) {
-                        return (stone == Stone::BLACK) ? GameStatus::BLACK_WIN : GameStatus::WHITE_WIN;
-                    }
-                }
-            }
+    // One line per game: B, W or D, then the moves as row,col
+    static std::string formatRecord(GameStatus result, const std::vector<Position>& history) {
+        std::string record = (result == GameStatus::BLACK_WIN) ? "B" :
+                             (result == GameStatus::WHITE_WIN) ? "W" : "D";
+        for (const auto& pos : history) {
+            record += " " + std::to_string(pos.row) + "," + std::to_string(pos.col);
         }
-        
-        if (isFull()) return GameStatus::DRAW;
-        return GameStatus::ONGOING;
+        return record;
     }
     
-    void display() const {
-        std::cout << "\n  ";
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            std::cout << std::setw(2) << i << " ";
-        }
-        std::cout << "\n";
-        
-        for (int r = 0; r < BOARD_SIZE; r++) {
-            std::cout << std::setw(2) << r << " ";
-            for (int c = 0; c < BOARD_SIZE; c++) {
-                char symbol = '.';
-                if (board[r][c] == Stone::BLACK) symbol = 'X';
-                else if (board[r][c] == Stone::WHITE) symbol = 'O';
-                std::cout << symbol << "  ";
-            }
-            std::cout << "\n";
-        }
-        std::cout << "\n";
+    static void updateMin(std::atomic<int>& target, int value) {
+        int current = target.load(std::memory_order_relaxed);
+        while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
     }
     
-    const std::vector<Position>& getMoveHistory() const { return moveHistory; }
-};
-
-class PatternEvaluator {
-private:
-    struct LinePattern {
-        int consecutive;
-        int openEnds;
-        int gaps;
-    };
-    
-    static LinePattern analyzeLine(const Board& board, Position start, 
-                                   int dr, int dc, Stone stone) {
-        LinePattern pattern = {1, 0, 0};
-        
-        // Check both directions
-        for (int dir = -1; dir <= 1; dir += 2) {
-            int count = 0;
-            bool blocked = false;
-            int gapCount = 0;
-            
-            for (int i = 1; i < WIN_LENGTH; i++) {
-                int r = start.row + dr * i * dir;
-                int c = start.col + dc * i * dir;
-                
-                Stone current = board.getStone(r, c);
-                
-                if (current == stone) {
-                    count++;
-                    if (gapCount > 0) pattern.gaps++;
-                    gapCount = 0;
-                } else if (current == Stone::EMPTY) {
-                    if (count > 0 && gapCount == 0) {
-                        gapCount++;
-                    } else {
-                        if (!blocked) pattern.openEnds++;
-                        break;
-                    }
-                } else {
-                    blocked = true;
-                    break;
-                }
-            }
-            
-            pattern.consecutive += count;
-        }
-        
-        return pattern;
+    static void updateMax(std::atomic<int>& target, int value) {
+        int current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
     }
     
 public:
-    static int evaluatePosition(const Board& board, Stone stone) {
-        int score = 0;
-        Stone opponent = (stone == Stone::BLACK) ? Stone::WHITE : Stone::BLACK;
-        
-        // Check all positions
-        for (int r = 0; r < BOARD_SIZE; r++) {
-            for (int c = 0; c < BOARD_SIZE; c++) {
-                Stone current = board.getStone(r, c);
-                if (current == Stone::EMPTY) continue;
-                
-                Position pos(r, c);
-                bool isMyStone = (current == stone);
-                int multiplier = isMyStone ? 1 : -1;
-                
-                // Analyze patterns in all directions
-                for (const auto& [dr, dc] : DIRECTIONS) {
-                    // Skip if we've already counted this line from another stone
-                    if (dr == 0 || (dr == 1 && dc >= 0)) {
-                        LinePattern pattern = analyzeLine(board, pos, dr, dc, current);
-                        score += multiplier * getPatternScore(pattern);
-                    }
-                }
-                
-                // Position value (center is more valuable)
-                int centerDist = std::abs(r - BOARD_SIZE/2) + std::abs(c - BOARD_SIZE/2);
-                score += multiplier * (BOARD_SIZE - centerDist);
-            }
-        }
-        
-        return score;
-    }
-    
-    static int getPatternScore(const LinePattern& pattern) {
-        if (pattern.consecutive >= 5) return PatternScore::FIVE;
-        if (pattern.consecutive == 4) {
-            if (pattern.openEnds == 2) return PatternScore::OPEN_FOUR;
-            if (pattern.openEnds == 1) return PatternScore::BLOCKED_FOUR;
-        }
-        if (pattern.consecutive == 3) {
-            if (pattern.openEnds == 2) return PatternScore::OPEN_THREE;
-            if (pattern.openEnds == 1) return PatternScore::BLOCKED_THREE;
-        }
-        if (pattern.consecutive == 2) {
-            if (pattern.openEnds == 2) return PatternScore::OPEN_TWO;
-            if (pattern.openEnds == 1) return PatternScore::BLOCKED_TWO;
-        }
-        if (pattern.consecutive == 1 && pattern.openEnds > 0) return PatternScore::ONE;
-        return 0;
-    }
-    
-    static bool isThreat(const Board& board, Position pos, Stone stone) {
-        // Check if placing a stone at pos creates a significant threat
-        Board tempBoard = board;
-        tempBoard.placeStone(pos.row, pos.col, stone);
-        
-        for (const auto& [dr, dc] : DIRECTIONS) {
-            LinePattern pattern = analyzeLine(tempBoard, pos, dr, dc, stone);
-            if (pattern.consecutive >= 4 || 
-                (pattern.consecutive == 3 && pattern.openEnds == 2)) {
-                return true;
-            }
-        }
-        
-        return false;
-    }
-};
-
-class GomokuAI {
-private:
-    Stone myStone;
-    Stone opponentStone;
-    int maxDepth;
-    std::mt19937 rng;
+    Game(int blackDepth = 6, int whiteDepth = 6,
+         std::chrono::milliseconds timePerMove = std::chrono::milliseconds(0)) 
+        : status(GameStatus::ONGOING), turnCount(0), blackDepth(blackDepth), whiteDepth(whiteDepth),
+          hashMegabytes(16), moveTime(timePerMove), headless(false), book(nullptr) {}
     
-    struct MoveScore {
-        Position move;
-        int score;
-        MoveScore(Position m, int s) : move(m), score(s) {}
-    };
-    
-    int minimax(Board& board, int depth, int alpha, int beta, bool isMaximizing) {
-        GameStatus status = board.checkWin();
-        
-        // Terminal node evaluation
-        if (status != GameStatus::ONGOING) {
-            if (status == GameStatus::DRAW) return 0;
-            bool iWon = (status == GameStatus::BLACK_WIN && myStone == Stone::BLACK) ||
-                       (status == GameStatus::WHITE_WIN && myStone == Stone::WHITE);
-            return iWon ? WIN_SCORE - depth : -WIN_SCORE + depth;
-        }
-        
-        if (depth >= maxDepth) {
-            return PatternEvaluator::evaluatePosition(board, myStone);
-        }
-        
-        std::vector<Position> moves = board.getRelevantMoves();
-        if (moves.empty()) return 0;
-        
-        // Move ordering for better pruning
-        orderMoves(board, moves, isMaximizing ? myStone : opponentStone);
-        
-        if (isMaximizing) {
-            int maxEval = -INFINITY_SCORE;
-            for (const auto& move : moves) {
-                board.placeStone(move.row, move.col, myStone);
-                int eval = minimax(board, depth + 1, alpha, beta, false);
-                board.removeStone(move.row, move.col);
-                
-                maxEval = std::max(maxEval, eval);
-                alpha = std::max(alpha, eval);
-                if (beta <= alpha) break; // Beta pruning
-            }
-            return maxEval;
-        } else {
-            int minEval = INFINITY_SCORE;
-            for (const auto& move : moves) {
-                board.placeStone(move.row, move.col, opponentStone);
-                int eval = minimax(board, depth + 1, alpha, beta, true);
-                board.removeStone(move.row, move.col);
-                
-                minEval = std::min(minEval, eval);
-                beta = std::min(beta, eval);
-                if (beta <= alpha) break; // Alpha pruning
-            }
-            return minEval;
-        }
+    void setHashSize(size_t megabytes) {
+        hashMegabytes = megabytes;
+        blackAI.setHashSize(megabytes);
+        whiteAI.setHashSize(megabytes);
     }
     
-    void orderMoves(Board& board, std::vector<Position>& moves, Stone stone) {
-        std::vector<MoveScore> scoredMoves;
-        
-        for (const auto& move : moves) {
-            int score = 0;
-            
-            // Check for immediate win
-            board.placeStone(move.row, move.col, stone);
-            if (board.checkWin() != GameStatus::ONGOING) {
-                score = INFINITY_SCORE;
-            } else {
-                // Quick evaluation
-                score = PatternEvaluator::evaluatePosition(board, stone);
-                
-                // Check if it blocks opponent's threat
-                Stone opponent = (stone == Stone::BLACK) ? Stone::WHITE : Stone::BLACK;
-                if (PatternEvaluator::isThreat(board, move, opponent)) {
-                    score += 5000;
-                }
-            }
-            board.removeStone(move.row, move.col);
-            
-            scoredMoves.emplace_back(move, score);
-        }
-        
-        // Sort moves by score (descending)
-        std::sort(scoredMoves.begin(), scoredMoves.end(),
-                 [](const MoveScore& a, const MoveScore& b) {
-                     return a.score > b.score;
-                 });
-        
-        moves.clear();
-        for (const auto& ms : scoredMoves) {
-            moves.push_back(ms.move);
-            if (moves.size() >= 10) break; // Limit branching factor
-        }
+    void setOpeningBook(const OpeningBook* openingBook) {
+        book = openingBook;
+        blackAI.setOpeningBook(openingBook);
+        whiteAI.setOpeningBook(openingBook);
     }
     
-public:
-    GomokuAI(Stone stone, int depth = MAX_DEPTH) 
-        : myStone(stone), 
-          opponentStone(stone == Stone::BLACK ? Stone::WHITE : Stone::BLACK),
-          maxDepth(depth),
-          rng(std::chrono::steady_clock::now().time_since_epoch().count()) {}
-    
-    Position getBestMove(Board& board) {
-        auto startTime = std::chrono::steady_clock::now();
-        
-        std::vector<Position> moves = board.getRelevantMoves();
-        if (moves.empty()) {
-            return Position(BOARD_SIZE / 2, BOARD_SIZE / 2);
-        }
-        
-        // Check for immediate win or block
-        for (const auto& move : moves) {
-            // Check for win
-            board.placeStone(move.row, move.col, myStone);
-            if (board.checkWin() != GameStatus::ONGOING) {
-                board.removeStone(move.row, move.col);
-                return move;
-            }
-            board.removeStone(move.row, move.col);
-            
-            // Check for blocking opponent's win
-            board.placeStone(move.row, move.col, opponentStone);
-            if (board.checkWin() != GameStatus::ONGOING) {
-                board.removeStone(move.row, move.col);
-                return move;
-            }
-            board.removeStone(move.row, move.col);
-        }
-        
-        // Use minimax for best move
-        Position bestMove = moves[0];
-        int bestScore = -INFINITY_SCORE;
-        
-        orderMoves(board, moves, myStone);
-        
-        for (const auto& move : moves) {
-            board.placeStone(move.row, move.col, myStone);
-            int score = minimax(board, 1, -INFINITY_SCORE, INFINITY_SCORE, false);
-            board.removeStone(move.row, move.col);
-            
-            // Add small random factor for variety
-            score += (rng() % 10) - 5;
-            
-            if (score > bestScore) {
-                bestScore = score;
-                bestMove = move;
-            }
-        }
-        
-        auto endTime = std::chrono::steady_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        
-        std::cout << "AI (" << (myStone == Stone::BLACK ? "Black" : "White") 
-                  << ") thinks for " << duration.count() << "ms, "
-                  << "score: " << bestScore << std::endl;
-        
-        return bestMove;
-    }
-};
-
-class Game {
-private:
-    Board board;
-    std::unique_ptr<GomokuAI> blackAI;
-    std::unique_ptr<GomokuAI> whiteAI;
-    GameStatus status;
-    int turnCount;
+    // Self-play records for building an opening book; empty: none
+    void setRecordFile(const std::string& path) { recordPath = path; }
     
-public:
-    Game(int blackDepth = 6, int whiteDepth = 6) 
-        : status(GameStatus::ONGOING), turnCount(0) {
-        blackAI = std::make_unique<GomokuAI>(Stone::BLACK, blackDepth);
-        whiteAI = std::make_unique<GomokuAI>(Stone::WHITE, whiteDepth);
-    }
+    void setHeadless(bool enabled) { headless = enabled; }
     
     void play() {
         std::cout << "=== GOMOKU AI vs AI ===" << std::endl;
@@ -494,7 +182,7 @@ public:
         std::cout << "Board size: " << BOARD_SIZE << "x" << BOARD_SIZE << std::endl;
         std::cout << "First to get 5 in a row wins!\n" << std::endl;
         
-        board.display();
+        displayBoard(board);
         
         while (status == GameStatus::ONGOING) {
             turnCount++;
@@ -504,20 +192,16 @@ public:
                      << (currentStone == Stone::BLACK ? "Black (X)" : "White (O)") 
                      << " is thinking..." << std::endl;
             
-            Position move;
-            if (currentStone == Stone::BLACK) {
-                move = blackAI->getBestMove(board);
-            } else {
-                move = whiteAI->getBestMove(board);
-            }
+            Position move = currentStone == Stone::BLACK ? think(blackAI, board, blackDepth, !headless)
+                                                         : think(whiteAI, board, whiteDepth, !headless);
             
             board.placeStone(move.row, move.col, currentStone);
             std::cout << "Placed at (" << move.row << ", " << move.col << ")" << std::endl;
             
-            board.display();
-            
             status = board.checkWin();
             
+            displayBoard(board);
+            
             // Add a small delay for visualization
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
         }
@@ -551,72 +235,173 @@ public:
         }
     }
     
-    void playMultipleGames(int numGames) {
-        int blackWins = 0, whiteWins = 0, draws = 0;
-        
-        for (int i = 0; i < numGames; i++) {
-            std::cout << "\n=== Game " << (i + 1) << " of " << numGames << " ===" << std::endl;
-            
-            // Reset for new game
-            board = Board();
-            status = GameStatus::ONGOING;
-            turnCount = 0;
-            
-            // Play silently
-            while (status == GameStatus::ONGOING) {
-                turnCount++;
-                Stone currentStone = (turnCount % 2 == 1) ? Stone::BLACK : Stone::WHITE;
-                
-                Position move;
-                if (currentStone == Stone::BLACK) {
-                    move = blackAI->getBestMove(board);
-                } else {
-                    move = whiteAI->getBestMove(board);
+    // Plays numGames independent games on a pool of jobs threads (zero: one
+    // per core). Game i is seeded from baseSeed + i, so a match is
+    // reproducible whatever the number of threads.
+    void playMultipleGames(int numGames, int jobs = 0, uint32_t baseSeed = 1) {
+        if (numGames <= 0) return;
+        if (jobs <= 0) jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        jobs = std::min(jobs, numGames);
+        
+        // Results are gathered without locks
+        std::atomic<int> nextGame(0);
+        std::atomic<int> blackWins(0), whiteWins(0), draws(0);
+        std::atomic<long long> totalMoves(0);
+        std::atomic<int> shortest(std::numeric_limits<int>::max()), longest(0);
+        std::vector<std::string> records(recordPath.empty() ? 0 : numGames);  // one slot per game
+        
+        auto runGames = [&] {
+            for (int i = nextGame.fetch_add(1); i < numGames; i = nextGame.fetch_add(1)) {
+                std::vector<Position> history;
+                GameStatus result = playIndependentGame(baseSeed + static_cast<uint32_t>(i), history);
+                int moves = static_cast<int>(history.size());
+                if (!records.empty()) {
+                    records[i] = formatRecord(result, history);
                 }
                 
-                board.placeStone(move.row, move.col, currentStone);
-                status = board.checkWin();
+                totalMoves.fetch_add(moves, std::memory_order_relaxed);
+                updateMin(shortest, moves);
+                updateMax(longest, moves);
+                
+                std::string line;
+                switch (result) {
+                    case GameStatus::BLACK_WIN:
+                        blackWins.fetch_add(1, std::memory_order_relaxed);
+                        line = "Black wins in " + std::to_string(moves) + " moves";
+                        break;
+                    case GameStatus::WHITE_WIN:
+                        whiteWins.fetch_add(1, std::memory_order_relaxed);
+                        line = "White wins in " + std::to_string(moves) + " moves";
+                        break;
+                    case GameStatus::DRAW:
+                        draws.fetch_add(1, std::memory_order_relaxed);
+                        line = "Draw after " + std::to_string(moves) + " moves";
+                        break;
+                    default:
+                        break;
+                }
+                if (!headless) {
+                    // One write per line so lines from different threads do not interleave
+                    std::cout << ("Game " + std::to_string(i + 1) + " of " + std::to_string(numGames) +
+                                  ": " + line + "\n") << std::flush;
+                }
             }
-            
-            // Record result
-            switch (status) {
-                case GameStatus::BLACK_WIN:
-                    blackWins++;
-                    std::cout << "Black wins in " << turnCount << " moves" << std::endl;
-                    break;
-                case GameStatus::WHITE_WIN:
-                    whiteWins++;
-                    std::cout << "White wins in " << turnCount << " moves" << std::endl;
-                    break;
-                case GameStatus::DRAW:
-                    draws++;
-                    std::cout << "Draw after " << turnCount << " moves" << std::endl;
-                    break;
-                default:
-                    break;
+        };
+        
+        std::vector<std::thread> pool;
+        for (int i = 1; i < jobs; i++) {
+            pool.emplace_back(runGames);
+        }
+        runGames();
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        
+        if (!records.empty()) {
+            std::ofstream out(recordPath, std::ios::app);
+            for (const auto& record : records) {
+                out << record << "\n";
+            }
+            if (!out) {
+                std::cerr << "Could not write game records to " << recordPath << std::endl;
             }
         }
         
         // Statistics
         std::cout << "\n=== STATISTICS ===" << std::endl;
+        std::cout << "Games: " << numGames << " on " << jobs << (jobs == 1 ? " thread" : " threads") << std::endl;
         std::cout << "Black wins: " << blackWins << " (" 
                   << (100.0 * blackWins / numGames) << "%)" << std::endl;
         std::cout << "White wins: " << whiteWins << " (" 
                   << (100.0 * whiteWins / numGames) << "%)" << std::endl;
         std::cout << "Draws: " << draws << " (" 
                   << (100.0 * draws / numGames) << "%)" << std::endl;
+        std::cout << "Game length: average " << (static_cast<double>(totalMoves) / numGames)
+                  << ", shortest " << shortest << ", longest " << longest << " moves" << std::endl;
     }
 };
 
-int main() {
+// Usage: gomoku [--batch <games>] [--jobs <threads>] [--seed <n>] [--depth <plies>]
+//               [--time <ms per move>] [--hash <MB per engine>] [--book <file>]
+//               [--record <file>]
+// --record appends the batch games for gmk-book-builder
+// --batch plays the games on a thread pool with no output but the statistics
+
+// Reads a whole decimal argument of at least minimum into value
+static bool parseNumber(const char* text, int minimum, int& value) {
+    try {
+        size_t used = 0;
+        int parsed = std::stoi(text, &used);
+        if (text[used] != '\0' || parsed < minimum) return false;
+        value = parsed;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+int main(int argc, char* argv[]) {
     try {
-        // Single game with visualization
-        Game game(6, 6);  // Both AIs use depth 6
-        game.play();
+        int batchGames = 0;
+        int depth = 6;
+        int moveTime = 0;
+        int jobs = 0;
+        uint32_t seed = 1;
+        int hashMegabytes = 16;
+        std::string bookPath;
+        std::string recordPath;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool valid = true;
+            int seedValue = 0;
+            if (i + 1 < argc && arg == "--batch") {
+                valid = parseNumber(argv[++i], 1, batchGames);
+            } else if (i + 1 < argc && arg == "--depth") {
+                valid = parseNumber(argv[++i], 1, depth);
+            } else if (i + 1 < argc && arg == "--time") {
+                valid = parseNumber(argv[++i], 0, moveTime);
+            } else if (i + 1 < argc && arg == "--jobs") {
+                valid = parseNumber(argv[++i], 0, jobs);
+            } else if (i + 1 < argc && arg == "--seed") {
+                valid = parseNumber(argv[++i], 0, seedValue);
+                seed = static_cast<uint32_t>(seedValue);
+            } else if (i + 1 < argc && arg == "--hash") {
+                valid = parseNumber(argv[++i], 1, hashMegabytes);
+            } else if (i + 1 < argc && arg == "--book") {
+                bookPath = argv[++i];
+            } else if (i + 1 < argc && arg == "--record") {
+                recordPath = argv[++i];
+            } else {
+                valid = false;
+            }
+            if (!valid) {
+                std::cerr << "Usage: " << argv[0]
+                          << " [--batch <games>] [--jobs <threads>] [--seed <n>]"
+                          << " [--depth <plies>] [--time <ms per move>] [--hash <MB per engine>]"
+                          << " [--book <file>] [--record <file>]" << std::endl;
+                return 1;
+            }
+        }
         
-        // Uncomment for multiple games statistics
-        // Game tournament(5, 5);
-        // tournament.playMultipleGames(10);
+        Game game(depth, depth, std::chrono::milliseconds(moveTime));
+        game.setHashSize(hashMegabytes);
+        game.setRecordFile(recordPath);
+        
+        OpeningBook book;
+        if (!bookPath.empty()) {
+            if (!book.open(bookPath)) {
+                std::cerr << "Cannot open opening book " << bookPath << std::endl;
+                return 1;
+            }
+            game.setOpeningBook(&book);
+        }
+        if (batchGames > 0) {
+            game.setHeadless(true);
+            game.playMultipleGames(batchGames, jobs, seed);
+        } else {
+            // Single game with visualization
+            game.play();
+        }
         
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -624,3 +409,4 @@ int main() {
     }
     
     return 0;
+}
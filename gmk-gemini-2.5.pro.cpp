@@ -1,16 +1,27 @@
 //created by gemini-2.5.pro
 #include <iostream>
 #include <vector>
+#include <array>
 #include <string>
 #include <algorithm>
 #include <limits>
 #include <chrono>
 #include <map>
+#include <cstdint>
+
+#include "zobrist.h"
+#include "transposition_table.h"
+#include "patterns.h"
+#include "opening_book.h"
 
 // --- Configuration ---
 constexpr int BOARD_SIZE = 15;
 constexpr int WIN_LENGTH = 5;
 constexpr int AI_SEARCH_DEPTH = 4; // Adjust for difficulty. 4 is strong, 6 is very strong.
+constexpr size_t AI_HASH_MB = 16;  // Transposition table size per AI player
+
+static_assert(BOARD_SIZE * BOARD_SIZE == Zobrist::BOARD_CELLS, "Zobrist keys assume a 15x15 board");
+static_assert(WIN_LENGTH == LinePatterns::SPAN, "line pattern tables assume five in a row");
 
 // --- Core Game Definitions ---
 
@@ -47,8 +58,17 @@ class GomokuGame {
 private:
     std::vector<std::vector<Cell>> board;
     int move_count = 0;
+    uint64_t hash = 0; // Zobrist key, updated on every make/undo
+    // Candidate moves, kept up to date by make/undo: the number of stones
+    // within NEAR_RANGE of each cell, and per row bit masks of the stones
+    // and of the empty cells where that count is non-zero
+    std::array<uint8_t, BOARD_SIZE * BOARD_SIZE> near_count{};
+    std::array<uint16_t, BOARD_SIZE> stone_rows{};
+    std::array<uint16_t, BOARD_SIZE> candidate_rows{};
 
 public:
+    static constexpr int NEAR_RANGE = 1;
+
     GomokuGame() : board(BOARD_SIZE, std::vector<Cell>(BOARD_SIZE, Cell::EMPTY)) {}
 
     // Prints the game board to the console
@@ -75,14 +95,20 @@ public:
     void makeMove(const Move& m, Cell player) {
         if (isValidMove(m.row, m.col)) {
             board[m.row][m.col] = player;
+            hash ^= Zobrist::stone(colorIndex(player), m.row * BOARD_SIZE + m.col);
             move_count++;
+            stone_rows[m.row] |= uint16_t(1u << m.col);
+            updateNear(m, 1);
         }
     }
     
     void undoMove(const Move& m) {
         if (m.row != -1 && m.col != -1) {
+            hash ^= Zobrist::stone(colorIndex(board[m.row][m.col]), m.row * BOARD_SIZE + m.col);
             board[m.row][m.col] = Cell::EMPTY;
             move_count--;
+            stone_rows[m.row] &= uint16_t(~(1u << m.col));
+            updateNear(m, -1);
         }
     }
 
@@ -135,6 +161,46 @@ public:
     }
     
     int getMoveCount() const { return move_count; }
+    
+    uint64_t getHash() const { return hash; }
+
+    // Empty cells within NEAR_RANGE of a stone, grouped by the first stone
+    // (in row-major order) they are near; the search relies on this order,
+    // which tries the cells around a cluster together
+    template <typename F>
+    void forEachCandidate(F&& visit) const {
+        std::array<uint16_t, BOARD_SIZE> pending = candidate_rows;
+        for (int r = 0; r < BOARD_SIZE; ++r) {
+            for (uint32_t stones = stone_rows[r], c = 0; stones; stones >>= 1, ++c) {
+                if (!(stones & 1)) continue;
+                for (int nr = std::max(0, r - NEAR_RANGE); nr <= std::min(BOARD_SIZE - 1, r + NEAR_RANGE); ++nr) {
+                    for (int nc = std::max(0, int(c) - NEAR_RANGE); nc <= std::min(BOARD_SIZE - 1, int(c) + NEAR_RANGE); ++nc) {
+                        if (pending[nr] & (1u << nc)) {
+                            pending[nr] &= uint16_t(~(1u << nc));
+                            visit(Move{nr, nc});
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static int colorIndex(Cell player) { return player == Cell::BLACK ? 0 : 1; }
+
+    // Adjusts the counts around a changed cell; O(NEAR_RANGE^2)
+    void updateNear(const Move& m, int delta) {
+        for (int r = std::max(0, m.row - NEAR_RANGE); r <= std::min(BOARD_SIZE - 1, m.row + NEAR_RANGE); ++r) {
+            for (int c = std::max(0, m.col - NEAR_RANGE); c <= std::min(BOARD_SIZE - 1, m.col + NEAR_RANGE); ++c) {
+                near_count[r * BOARD_SIZE + c] += delta;
+                if (near_count[r * BOARD_SIZE + c] > 0 && board[r][c] == Cell::EMPTY) {
+                    candidate_rows[r] |= uint16_t(1u << c);
+                } else {
+                    candidate_rows[r] &= uint16_t(~(1u << c));
+                }
+            }
+        }
+    }
 };
 
 
@@ -145,26 +211,54 @@ private:
     Cell ai_player;
     Cell opponent_player;
     int search_depth;
+    TranspositionTable tt;
+    const OpeningBook* book = nullptr; // consulted before searching; not owned
+
+    // Rows, columns and both diagonal directions
+    static const int LINE_COUNT = 6 * BOARD_SIZE - 2;
+
+    // The board evaluation, kept incrementally: the score of every line,
+    // updated as the search makes and takes back moves, and their sum
+    std::array<int, LINE_COUNT> line_scores{};
+    int total_score = 0;
+
+    // Candidate moves of each search depth (the root's at search_depth),
+    // reserved for a full board up front so the search never allocates
+    std::vector<std::vector<Move>> move_stack;
 
     // Scores for different patterns. Higher is better.
-    const int SCORE_FIVE = 100000000;
-    const int SCORE_OPEN_FOUR = 1000000;
-    const int SCORE_HALF_OPEN_FOUR = 10000;
-    const int SCORE_OPEN_THREE = 5000;
-    const int SCORE_HALF_OPEN_THREE = 100;
-    const int SCORE_OPEN_TWO = 50;
-    const int SCORE_HALF_OPEN_TWO = 10;
-    const int SCORE_ONE = 1;
+    static constexpr int SCORE_FIVE = 100000000;
+    static constexpr int SCORE_OPEN_FOUR = 1000000;
+    static constexpr int SCORE_HALF_OPEN_FOUR = 10000;
+    static constexpr int SCORE_OPEN_THREE = 5000;
+    static constexpr int SCORE_HALF_OPEN_THREE = 100;
+    static constexpr int SCORE_OPEN_TWO = 50;
+    static constexpr int SCORE_HALF_OPEN_TWO = 10;
+    static constexpr int SCORE_ONE = 1;
 
 public:
-    AIPlayer(Cell player_color, int depth) : ai_player(player_color), search_depth(depth) {
+    AIPlayer(Cell player_color, int depth, size_t hash_mb = AI_HASH_MB)
+        : ai_player(player_color), search_depth(depth), tt(hash_mb), move_stack(depth + 1) {
         opponent_player = getOpponent(player_color);
+        for (auto& moves : move_stack) {
+            moves.reserve(BOARD_SIZE * BOARD_SIZE);
+        }
     }
 
+    void setOpeningBook(const OpeningBook* opening_book) { book = opening_book; }
+
     Move findBestMove(GomokuGame& game) {
+        int book_move;
+        if (book && book->probe(game.getHash(), book_move) && book_move < BOARD_SIZE * BOARD_SIZE &&
+            game.isValidMove(book_move / BOARD_SIZE, book_move % BOARD_SIZE)) {
+            return {book_move / BOARD_SIZE, book_move % BOARD_SIZE};
+        }
+
+        tt.newSearch();
+        initScores(game.getBoard());
         Move best_move;
         int best_score = std::numeric_limits<int>::min();
-        auto candidate_moves = generateMoves(game.getBoard());
+        auto& candidate_moves = generateMoves(game, search_depth);
 
         // First move optimization: play in the center
         if (game.getMoveCount() == 0) {
@@ -172,9 +266,9 @@ public:
         }
 
         for (const auto& move : candidate_moves) {
-            game.makeMove(move, ai_player);
+            playMove(game, move, ai_player);
             int score = minimax(game, search_depth - 1, false, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), move);
-            game.undoMove(move);
+            takeBack(game, move);
 
             if (score > best_score) {
                 best_score = score;
@@ -194,115 +288,182 @@ private:
             return 0;
         }
         if (depth == 0) {
-            return evaluateBoard(game.getBoard());
+            return total_score;
+        }
+
+        // Transposition table lookup; the key includes the side to move
+        Cell to_move = is_maximizing ? ai_player : opponent_player;
+        uint64_t key = game.getHash() ^ (to_move == Cell::WHITE ? Zobrist::sideToMove() : 0);
+        int hash_move = TranspositionTable::NO_MOVE;
+        TranspositionTable::Entry entry;
+        if (tt.probe(key, entry)) {
+            hash_move = entry.move;
+            if (entry.depth >= depth) {
+                if (entry.bound == TranspositionTable::Bound::EXACT) return entry.score;
+                if (entry.bound == TranspositionTable::Bound::LOWER) alpha = std::max(alpha, entry.score);
+                if (entry.bound == TranspositionTable::Bound::UPPER) beta = std::min(beta, entry.score);
+                if (beta <= alpha) return entry.score;
+            }
         }
+        const int alpha_orig = alpha;
+        const int beta_orig = beta;
 
-        auto candidate_moves = generateMoves(game.getBoard());
+        auto& candidate_moves = generateMoves(game, depth);
+        if (candidate_moves.empty()) {
+            return 0;
+        }
 
+        // Try the stored best move first
+        if (hash_move != TranspositionTable::NO_MOVE) {
+            auto it = std::find_if(candidate_moves.begin(), candidate_moves.end(), [&](const Move& m) {
+                return m.row * BOARD_SIZE + m.col == hash_move;
+            });
+            if (it != candidate_moves.end()) {
+                std::iter_swap(candidate_moves.begin(), it);
+            }
+        }
+
+        int best_eval;
+        Move best_move = candidate_moves.front();
         if (is_maximizing) {
             int max_eval = std::numeric_limits<int>::min();
             for (const auto& move : candidate_moves) {
-                game.makeMove(move, ai_player);
+                playMove(game, move, ai_player);
                 int eval = minimax(game, depth - 1, false, alpha, beta, move);
-                game.undoMove(move);
-                max_eval = std::max(max_eval, eval);
+                takeBack(game, move);
+                if (eval > max_eval) {
+                    max_eval = eval;
+                    best_move = move;
+                }
                 alpha = std::max(alpha, eval);
                 if (beta <= alpha) {
                     break; // Prune
                 }
             }
-            return max_eval;
+            best_eval = max_eval;
         } else { // Minimizing player
             int min_eval = std::numeric_limits<int>::max();
             for (const auto& move : candidate_moves) {
-                game.makeMove(move, opponent_player);
+                playMove(game, move, opponent_player);
                 int eval = minimax(game, depth - 1, true, alpha, beta, move);
-                game.undoMove(move);
-                min_eval = std::min(min_eval, eval);
+                takeBack(game, move);
+                if (eval < min_eval) {
+                    min_eval = eval;
+                    best_move = move;
+                }
                 beta = std::min(beta, eval);
                 if (beta <= alpha) {
                     break; // Prune
                 }
             }
-            return min_eval;
+            best_eval = min_eval;
         }
+
+        TranspositionTable::Bound bound = TranspositionTable::Bound::EXACT;
+        if (best_eval <= alpha_orig) bound = TranspositionTable::Bound::UPPER;
+        else if (best_eval >= beta_orig) bound = TranspositionTable::Bound::LOWER;
+        tt.store(key, depth, bound, best_eval, best_move.row * BOARD_SIZE + best_move.col);
+
+        return best_eval;
     }
     
-    // Generates moves only in the vicinity of existing pieces for efficiency
-    std::vector<Move> generateMoves(const std::vector<std::vector<Cell>>& board) {
-        std::vector<Move> moves;
-        std::vector<std::vector<bool>> visited(BOARD_SIZE, std::vector<bool>(BOARD_SIZE, false));
+    // Generates moves only in the vicinity of existing pieces for efficiency;
+    // the game keeps the set of such cells up to date as stones come and go.
+    // Fills and returns the move list of the given depth.
+    std::vector<Move>& generateMoves(const GomokuGame& game, int depth) {
+        std::vector<Move>& moves = move_stack[depth];
+        moves.clear();
+        game.forEachCandidate([&](const Move& m) { moves.push_back(m); });
+        return moves;
+    }
 
-        for (int r = 0; r < BOARD_SIZE; ++r) {
-            for (int c = 0; c < BOARD_SIZE; ++c) {
-                if (board[r][c] == Cell::EMPTY) continue;
-
-                // Check a 3x3 area around each existing piece
-                for (int dr = -1; dr <= 1; ++dr) {
-                    for (int dc = -1; dc <= 1; ++dc) {
-                        int nr = r + dr;
-                        int nc = c + dc;
-
-                        if (nr >= 0 && nr < BOARD_SIZE && nc >= 0 && nc < BOARD_SIZE &&
-                            board[nr][nc] == Cell::EMPTY && !visited[nr][nc]) {
-                            moves.push_back({nr, nc});
-                            visited[nr][nc] = true;
-                        }
-                    }
-                }
-            }
+    void playMove(GomokuGame& game, const Move& m, Cell player) {
+        game.makeMove(m, player);
+        rescoreLines(game.getBoard(), m);
+    }
+
+    void takeBack(GomokuGame& game, const Move& m) {
+        game.undoMove(m);
+        rescoreLines(game.getBoard(), m);
+    }
+
+    // Start cell and direction of line `id`: rows, columns, diagonals
+    // (indexed by r - c) and anti-diagonals (indexed by r + c)
+    static void lineStart(int id, int& r, int& c, int& dr, int& dc) {
+        if (id < BOARD_SIZE) {
+            r = id; c = 0; dr = 0; dc = 1;
+        } else if (id < 2 * BOARD_SIZE) {
+            r = 0; c = id - BOARD_SIZE; dr = 1; dc = 0;
+        } else if (id < 4 * BOARD_SIZE - 1) {
+            int d = id - 2 * BOARD_SIZE - (BOARD_SIZE - 1);
+            r = std::max(d, 0); c = std::max(-d, 0); dr = 1; dc = 1;
+        } else {
+            int s = id - (4 * BOARD_SIZE - 1);
+            r = std::max(s - (BOARD_SIZE - 1), 0); c = std::min(s, BOARD_SIZE - 1); dr = 1; dc = -1;
         }
-        return moves;
     }
 
-    // The core heuristic function: evaluates the entire board state
-    int evaluateBoard(const std::vector<std::vector<Cell>>& board) {
-        int score = 0;
-        // Evaluate rows, columns, and diagonals
-        for (int i = 0; i < BOARD_SIZE; ++i) {
-            score += evaluateLine(board, i, 0, 0, 1); // Rows
-            score += evaluateLine(board, 0, i, 1, 0); // Columns
+    int scoreLine(const std::vector<std::vector<Cell>>& board, int id) {
+        int r, c, dr, dc;
+        lineStart(id, r, c, dr, dc);
+        return evaluateLine(board, r, c, dr, dc);
+    }
+
+    void initScores(const std::vector<std::vector<Cell>>& board) {
+        total_score = 0;
+        for (int id = 0; id < LINE_COUNT; ++id) {
+            line_scores[id] = scoreLine(board, id);
+            total_score += line_scores[id];
         }
-        // Diagonals
-        for (int i = 0; i < BOARD_SIZE; ++i) {
-            score += evaluateLine(board, i, 0, 1, 1); // Top-left to bottom-right
-            if (i > 0) score += evaluateLine(board, 0, i, 1, 1);
-            
-            score += evaluateLine(board, i, 0, 1, -1); // Top-right to bottom-left
-            if (i > 0) score += evaluateLine(board, 0, i, 1, -1);
+    }
+
+    // Only the four lines through the changed cell can change score
+    void rescoreLines(const std::vector<std::vector<Cell>>& board, const Move& m) {
+        const int ids[4] = {
+            m.row,
+            BOARD_SIZE + m.col,
+            2 * BOARD_SIZE + (m.row - m.col + BOARD_SIZE - 1),
+            4 * BOARD_SIZE - 1 + (m.row + m.col)
+        };
+        for (int id : ids) {
+            int score = scoreLine(board, id);
+            total_score += score - line_scores[id];
+            line_scores[id] = score;
         }
-        return score;
     }
 
-    // Evaluates a single line (row, col, or diagonal)
+    // Evaluates a single line (row, col, or diagonal) by sliding a
+    // five-cell window along it
     int evaluateLine(const std::vector<std::vector<Cell>>& board, int r_start, int c_start, int dr, int dc) {
-        int ai_score = 0;
-        int opponent_score = 0;
-
-        for (int i = 0; i <= BOARD_SIZE - WIN_LENGTH; ++i) {
-            int r = r_start + i * dr;
-            int c = c_start + i * dc;
-            if (r < 0 || r >= BOARD_SIZE || c < 0 || c >= BOARD_SIZE) continue;
-            
-            ai_score += scoreWindow(board, r, c, dr, dc, ai_player);
-            opponent_score += scoreWindow(board, r, c, dr, dc, opponent_player);
+        int score = 0;
+        int key = 0;
+        int length = 0;
+
+        for (int r = r_start, c = c_start; r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE; r += dr, c += dc) {
+            int cell = board[r][c] == Cell::EMPTY ? LinePatterns::EMPTY
+                     : board[r][c] == ai_player ? LinePatterns::OWN : LinePatterns::OPPONENT;
+            key = (key >> 2) | (cell << (2 * (WIN_LENGTH - 1)));
+            if (++length >= WIN_LENGTH) score += WINDOW_SCORES[key];
         }
-        return ai_score - opponent_score;
+        return score;
     }
-    
+
+    // AI score minus opponent score of every five-cell window, indexed by
+    // the window's packed cells (OWN = the AI)
+    static const std::array<int, LinePatterns::SPAN_KEY_COUNT> WINDOW_SCORES;
+
+    static constexpr int scoreWindow(const std::array<LinePatterns::Cell, LinePatterns::SPAN>& cells) {
+        return scoreWindowFor(cells, LinePatterns::OWN) - scoreWindowFor(cells, LinePatterns::OPPONENT);
+    }
+
     // Scores a window of size WIN_LENGTH
-    int scoreWindow(const std::vector<std::vector<Cell>>& board, int r_start, int c_start, int dr, int dc, Cell player) {
+    static constexpr int scoreWindowFor(const std::array<LinePatterns::Cell, LinePatterns::SPAN>& cells, LinePatterns::Cell player) {
         int player_count = 0;
         int empty_count = 0;
 
-        for (int k = 0; k < WIN_LENGTH; ++k) {
-            int r = r_start + k * dr;
-            int c = c_start + k * dc;
-
-            if (r < 0 || r >= BOARD_SIZE || c < 0 || c >= BOARD_SIZE) return 0; // Out of bounds
-
-            if (board[r][c] == player) player_count++;
-            else if (board[r][c] == Cell::EMPTY) empty_count++;
+        for (LinePatterns::Cell cell : cells) {
+            if (cell == player) player_count++;
+            else if (cell == LinePatterns::EMPTY) empty_count++;
             else return 0; // Contains opponent's piece, no threat for `player` in this window
         }
 
@@ -321,12 +482,31 @@ private:
 
 };
 
+inline constexpr std::array<int, LinePatterns::SPAN_KEY_COUNT> AIPlayer::WINDOW_SCORES =
+    LinePatterns::buildSpans<int>(AIPlayer::scoreWindow);
+
 // --- Main Game Loop ---
 
-int main() {
+// Usage: gmk-gemini-2.5.pro [--book <file>]
+int main(int argc, char* argv[]) {
+    OpeningBook book;
+    if (argc == 3 && std::string(argv[1]) == "--book") {
+        if (!book.open(argv[2])) {
+            std::cerr << "Cannot open opening book " << argv[2] << std::endl;
+            return 1;
+        }
+    } else if (argc != 1) {
+        std::cerr << "Usage: " << argv[0] << " [--book <file>]" << std::endl;
+        return 1;
+    }
+
     GomokuGame game;
     AIPlayer ai_black(Cell::BLACK, AI_SEARCH_DEPTH);
     AIPlayer ai_white(Cell::WHITE, AI_SEARCH_DEPTH);
+    if (book.isOpen()) {
+        ai_black.setOpeningBook(&book);
+        ai_white.setOpeningBook(&book);
+    }
 
     Cell current_player = Cell::BLACK;
     Move last_move;
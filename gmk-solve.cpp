@@ -0,0 +1,158 @@
+// Proves or disproves a forced win for the side to move in each board file
+// with libgomoku's df-pn solver, for puzzles and endgame positions.
+//
+// A board file holds 15 rows of 15 cells: X or x for black, O or o for
+// white, . for empty. Spaces are ignored, and lines starting with # are
+// comments. Black moves first, so black is to move when the counts are
+// equal and white when black has one stone more.
+//
+// Each file gets one line: the side to move and its first winning move as
+// row,col, or why there is none, with the nodes searched and the time.
+// --tree adds the proof below it: each attacker move, then every defence
+// indented under it with the winning answer under that.
+//
+// Usage: gmk-solve [--attacks fours|threats|all] [--memory <MB>] [--nodes <n>] [--time <ms>] [--tree] <board-file>...
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cctype>
+
+#include "dfpn.h"
+
+using namespace gomoku;
+
+// Reads a board file into board, placing the stones alternately so the
+// side to move follows from the counts; error says what is wrong otherwise
+bool readBoard(const std::string& path, Board& board, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open file";
+        return false;
+    }
+    std::vector<Position> black, white;
+    std::string line;
+    int row = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] == '#') continue;
+        line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); }), line.end());
+        if (line.empty()) continue;
+        if (row == BOARD_SIZE || line.size() != BOARD_SIZE) {
+            error = "expected " + std::to_string(BOARD_SIZE) + " rows of " + std::to_string(BOARD_SIZE) + " cells";
+            return false;
+        }
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            char cell = line[col];
+            if (cell == 'X' || cell == 'x') {
+                black.emplace_back(row, col);
+            } else if (cell == 'O' || cell == 'o') {
+                white.emplace_back(row, col);
+            } else if (cell != '.') {
+                error = std::string("unknown cell '") + cell + "' in row " + std::to_string(row + 1);
+                return false;
+            }
+        }
+        row++;
+    }
+    if (row != BOARD_SIZE) {
+        error = "expected " + std::to_string(BOARD_SIZE) + " rows of " + std::to_string(BOARD_SIZE) + " cells";
+        return false;
+    }
+    if (black.size() != white.size() && black.size() != white.size() + 1) {
+        error = "black must have as many stones as white or one more";
+        return false;
+    }
+
+    board = Board();
+    for (size_t i = 0; i < black.size(); i++) {
+        board.placeStone(black[i].row, black[i].col, Stone::BLACK);
+        if (i < white.size()) board.placeStone(white[i].row, white[i].col, Stone::WHITE);
+    }
+    if (board.checkWin() != GameStatus::ONGOING) {
+        error = "the game is already over";
+        return false;
+    }
+    return true;
+}
+
+void printProof(const std::vector<ProofSolver::ProofNode>& proof, int indent) {
+    for (const auto& node : proof) {
+        std::cout << std::string(indent, ' ') << node.move.row << "," << node.move.col << "\n";
+        printProof(node.replies, indent + 2);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ProofSolver::Limits limits;
+    size_t memoryMegabytes = 256;
+    bool printTree = false;
+    std::vector<std::string> paths;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--attacks") {
+            std::string attacks = argv[++i];
+            if (attacks == "fours") limits.attacks = ProofSolver::Attacks::FOURS;
+            else if (attacks == "threats") limits.attacks = ProofSolver::Attacks::THREATS;
+            else if (attacks == "all") limits.attacks = ProofSolver::Attacks::ALL;
+            else usage = true;
+        } else if (i + 1 < argc && arg == "--memory") {
+            memoryMegabytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (i + 1 < argc && arg == "--nodes") {
+            limits.nodes = std::max(0LL, std::atoll(argv[++i]));
+        } else if (i + 1 < argc && arg == "--time") {
+            limits.time = std::chrono::milliseconds(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--tree") {
+            printTree = true;
+        } else if (!arg.empty() && arg[0] != '-') {
+            paths.push_back(arg);
+        } else {
+            usage = true;
+        }
+    }
+    if (usage || paths.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--attacks fours|threats|all] [--memory <MB>] [--nodes <n>] [--time <ms>] [--tree] <board-file>..."
+                  << std::endl;
+        return 1;
+    }
+    limits.proofTree = printTree;
+
+    ProofSolver solver(memoryMegabytes);
+    int failures = 0;
+    for (const auto& path : paths) {
+        Board board;
+        std::string error;
+        if (!readBoard(path, board, error)) {
+            std::cerr << path << ": " << error << std::endl;
+            failures++;
+            continue;
+        }
+
+        ProofSolver::Result result = solver.solve(board, limits);
+        const char* side = board.sideToMove() == Stone::BLACK ? "black" : "white";
+        std::cout << path << ": ";
+        switch (result.status) {
+            case ProofSolver::Result::Status::PROVEN:
+                std::cout << side << " to move wins with " << result.move.row << "," << result.move.col;
+                if (limits.attacks == ProofSolver::Attacks::ALL) std::cout << " against replies in line with a stone";
+                break;
+            case ProofSolver::Result::Status::DISPROVEN:
+                std::cout << side << " to move has no forced win ";
+                if (limits.attacks == ProofSolver::Attacks::FOURS) std::cout << "by fours";
+                else if (limits.attacks == ProofSolver::Attacks::THREATS) std::cout << "by threats";
+                else std::cout << "with moves near the stones";
+                break;
+            default:
+                std::cout << "unknown, limit reached";
+                break;
+        }
+        std::cout << " (" << result.nodes << " nodes, " << result.elapsed.count() << " ms)" << std::endl;
+        if (printTree) printProof(result.proof, 2);
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -5,27 +5,44 @@
 #include <cstdlib>
 #include <ctime>
 #include <algorithm>
+#include <array>
+#include "patterns.h"
+#include "padded_board.h"
+#include "board_scorer.h"
 
 class Gomoku {
 private:
     static const int BOARD_SIZE = 15;
     static const int WIN_COUNT = 5;
-    std::vector<std::vector<int>> board;
+    PaddedBoard board;
     int currentPlayer;
     bool gameOver;
     int winner;
     int moveCount;
     bool vsAI;
     int aiDifficulty;
+    BoardScorer::Scores blackScores;  // line scores of every cell, see findBestMove
+    BoardScorer::Scores whiteScores;
 
     struct Move {
         int row, col, score;
         Move(int r = -1, int c = -1, int s = 0) : row(r), col(c), score(s) {}
     };
 
+    // Score of a stone's shape in one direction, indexed by line key
+    static const std::array<int, LinePatterns::KEY_COUNT> LINE_SCORES;
+
+    static int scoreLine(const LinePatterns::Window& window) {
+        int count = LinePatterns::run(window);
+        if (count >= WIN_COUNT) return 10000; // Winning move
+        if (count == 4) return 1000;
+        if (count == 3) return 100;
+        if (count == 2) return 10;
+        return 0;
+    }
+
 public:
-    Gomoku() : board(BOARD_SIZE, std::vector<int>(BOARD_SIZE, 0)), 
-               currentPlayer(1), gameOver(false), winner(0), moveCount(0),
+    Gomoku() : currentPlayer(1), gameOver(false), winner(0), moveCount(0),
                vsAI(false), aiDifficulty(2) {
         std::srand(std::time(nullptr));
     }
@@ -45,8 +62,8 @@ public:
             std::cout << std::setw(2) << i << "|";
             for (int j = 0; j < BOARD_SIZE; j++) {
                 char symbol = '.';
-                if (board[i][j] == 1) symbol = 'X';
-                else if (board[i][j] == 2) symbol = 'O';
+                if (board.at(i, j) == 1) symbol = 'X';
+                else if (board.at(i, j) == 2) symbol = 'O';
                 std::cout << " " << symbol << " ";
             }
             std::cout << "\n";
@@ -57,7 +74,7 @@ public:
     bool isValidMove(int row, int col) {
         return row >= 0 && row < BOARD_SIZE && 
                col >= 0 && col < BOARD_SIZE && 
-               board[row][col] == 0;
+               board.at(row, col) == 0;
     }
 
     bool makeMove(int row, int col) {
@@ -65,7 +82,7 @@ public:
             return false;
         }
 
-        board[row][col] = currentPlayer;
+        board.set(row, col, currentPlayer);
         moveCount++;
 
         if (checkWin(row, col)) {
@@ -82,73 +99,26 @@ public:
     }
 
     int countConsecutive(int row, int col, int dRow, int dCol, int player) {
-        int count = 0;
-        int r = row + dRow;
-        int c = col + dCol;
-        
-        while (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && 
-               board[r][c] == player) {
-            count++;
-            r += dRow;
-            c += dCol;
-        }
-        
-        return count;
-    }
-
-    int evaluatePosition(int row, int col, int player) {
-        if (!isValidMove(row, col)) return -1;
-        
-        int score = 0;
-        board[row][col] = player; // Temporarily place piece
-        
-        // Check all four directions
-        int directions[4][2] = {{0,1}, {1,0}, {1,1}, {1,-1}};
-        
-        for (auto& dir : directions) {
-            int count = 1;
-            count += countConsecutive(row, col, dir[0], dir[1], player);
-            count += countConsecutive(row, col, -dir[0], -dir[1], player);
-            
-            if (count >= WIN_COUNT) {
-                score += 10000; // Winning move
-            } else if (count == 4) {
-                score += 1000;
-            } else if (count == 3) {
-                score += 100;
-            } else if (count == 2) {
-                score += 10;
-            }
-        }
-        
-        board[row][col] = 0; // Remove temporary piece
-        return score;
+        return board.countRun(PaddedBoard::index(row, col), PaddedBoard::step(dRow, dCol), player);
     }
 
     Move findBestMove() {
         std::vector<Move> moves;
         
+        // Line scores of every cell for both players in one pass
+        BoardScorer::scoreAll(board, LINE_SCORES.data(), blackScores, whiteScores);
+        
         // Consider moves near existing pieces
         for (int i = 0; i < BOARD_SIZE; i++) {
             for (int j = 0; j < BOARD_SIZE; j++) {
-                if (board[i][j] != 0) continue;
+                if (board.at(i, j) != 0) continue;
                 
                 // Check if there's a piece nearby
-                bool hasNeighbor = false;
-                for (int di = -2; di <= 2 && !hasNeighbor; di++) {
-                    for (int dj = -2; dj <= 2; dj++) {
-                        int ni = i + di, nj = j + dj;
-                        if (ni >= 0 && ni < BOARD_SIZE && nj >= 0 && nj < BOARD_SIZE && 
-                            board[ni][nj] != 0) {
-                            hasNeighbor = true;
-                            break;
-                        }
-                    }
-                }
+                bool hasNeighbor = board.hasNeighbour(i, j, 2);
                 
                 if (hasNeighbor || moveCount == 0) {
-                    int attackScore = evaluatePosition(i, j, 2); // AI's move
-                    int defenseScore = evaluatePosition(i, j, 1); // Block opponent
+                    int attackScore = whiteScores[PaddedBoard::index(i, j)]; // AI's move
+                    int defenseScore = blackScores[PaddedBoard::index(i, j)]; // Block opponent
                     int totalScore = attackScore + defenseScore * 0.9; // Slightly favor attack
                     
                     moves.push_back(Move(i, j, totalScore));
@@ -182,7 +152,7 @@ public:
 
     bool checkDirection(int row, int col, int dRow, int dCol) {
         int count = 1;
-        int player = board[row][col];
+        int player = board.at(row, col);
 
         count += countConsecutive(row, col, dRow, dCol, player);
         count += countConsecutive(row, col, -dRow, -dCol, player);
@@ -262,11 +232,7 @@ public:
     }
 
     void reset() {
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                board[i][j] = 0;
-            }
-        }
+        board.clear();
         currentPlayer = 1;
         gameOver = false;
         winner = 0;
@@ -274,6 +240,8 @@ public:
     }
 };
 
+const std::array<int, LinePatterns::KEY_COUNT> Gomoku::LINE_SCORES = LinePatterns::build<int>(Gomoku::scoreLine);
+
 int main() {
     Gomoku game;
     char playAgain;
@@ -0,0 +1,168 @@
+// batch_playout.cpp - Bit-sliced playouts of libgomoku, 64 games per machine word
+#include "batch_playout.h"
+
+#include "board.h"
+#include "board_scorer.h"
+
+namespace gomoku {
+
+namespace {
+
+// Board cells in row order, for uniform sampling
+const std::array<int, PaddedBoard::SIZE * PaddedBoard::SIZE>& boardCells() {
+    static const auto cells = [] {
+        std::array<int, PaddedBoard::SIZE * PaddedBoard::SIZE> list{};
+        for (int row = 0; row < PaddedBoard::SIZE; row++) {
+            for (int col = 0; col < PaddedBoard::SIZE; col++) {
+                list[row * PaddedBoard::SIZE + col] = PaddedBoard::index(row, col);
+            }
+        }
+        return list;
+    }();
+    return cells;
+}
+
+}  // namespace
+
+void BatchPlayout::reset(const PaddedBoard& board, int sideToMove) {
+    emptyCells = 0;
+    for (int i = 0; i < PaddedBoard::CELLS; i++) {
+        int cell = board[i];
+        stones[0][i] = cell == PaddedBoard::BLACK ? ~Lanes(0) : 0;
+        stones[1][i] = cell == PaddedBoard::WHITE ? ~Lanes(0) : 0;
+        empty[i] = cell == PaddedBoard::EMPTY ? ~Lanes(0) : 0;
+        emptyCells += cell == PaddedBoard::EMPTY;
+    }
+    side = sideToMove;
+}
+
+void BatchPlayout::fiveCells(const Lanes* own, const Lanes* emptyLanes, Lanes* out) {
+    static const auto kernel = BoardScorer::hasAvx2() ? fiveCellsAvx2 : fiveCellsScalar;
+    kernel(own, emptyLanes, out);
+}
+
+// For each direction, before[k] and after[k] are the lanes with k own
+// stones in a row just before and just after the cell; a window of five
+// through the cell holds four of them when before[k] & after[4 - k]
+void BatchPlayout::fiveCellsScalar(const Lanes* own, const Lanes* emptyLanes, Lanes* out) {
+    for (int i = FIRST; i < LAST; i++) {
+        Lanes five = 0;
+        for (int step : PaddedBoard::DIRECTIONS) {
+            Lanes before1 = own[i - step];
+            Lanes before2 = before1 & own[i - 2 * step];
+            Lanes before3 = before2 & own[i - 3 * step];
+            Lanes before4 = before3 & own[i - 4 * step];
+            Lanes after1 = own[i + step];
+            Lanes after2 = after1 & own[i + 2 * step];
+            Lanes after3 = after2 & own[i + 3 * step];
+            Lanes after4 = after3 & own[i + 4 * step];
+            five |= before4 | (before3 & after1) | (before2 & after2) | (before1 & after3) | after4;
+        }
+        out[i] = five & emptyLanes[i];
+    }
+}
+
+#ifdef BOARD_SCORER_X86
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+#endif
+void BatchPlayout::fiveCellsAvx2(const Lanes* own, const Lanes* emptyLanes, Lanes* out) {
+    // Four cells per step; the last step runs into border cells, whose
+    // empty words are zero, and stays inside the padded arrays
+    for (int i = FIRST; i < LAST; i += 4) {
+        auto at = [&](int cell) { return reinterpret_cast<const __m256i*>(own + cell); };
+        __m256i five = _mm256_setzero_si256();
+        for (int step : PaddedBoard::DIRECTIONS) {
+            __m256i before1 = _mm256_loadu_si256(at(i - step));
+            __m256i before2 = _mm256_and_si256(before1, _mm256_loadu_si256(at(i - 2 * step)));
+            __m256i before3 = _mm256_and_si256(before2, _mm256_loadu_si256(at(i - 3 * step)));
+            __m256i before4 = _mm256_and_si256(before3, _mm256_loadu_si256(at(i - 4 * step)));
+            __m256i after1 = _mm256_loadu_si256(at(i + step));
+            __m256i after2 = _mm256_and_si256(after1, _mm256_loadu_si256(at(i + 2 * step)));
+            __m256i after3 = _mm256_and_si256(after2, _mm256_loadu_si256(at(i + 3 * step)));
+            __m256i after4 = _mm256_and_si256(after3, _mm256_loadu_si256(at(i + 4 * step)));
+            five = _mm256_or_si256(five, _mm256_or_si256(before4, after4));
+            five = _mm256_or_si256(five, _mm256_and_si256(before3, after1));
+            five = _mm256_or_si256(five, _mm256_and_si256(before2, after2));
+            five = _mm256_or_si256(five, _mm256_and_si256(before1, after3));
+        }
+        __m256i free = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(emptyLanes + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(five, free));
+    }
+}
+#else
+void BatchPlayout::fiveCellsAvx2(const Lanes* own, const Lanes* emptyLanes, Lanes* out) {
+    fiveCellsScalar(own, emptyLanes, out);
+}
+#endif
+
+static_assert(PaddedBoard::index(0, 0) >= LinePatterns::REACH * (PaddedBoard::STRIDE + 1) &&
+                  PaddedBoard::index(PaddedBoard::SIZE - 1, PaddedBoard::SIZE - 1) + 4 +
+                          LinePatterns::REACH * (PaddedBoard::STRIDE + 1) <= PaddedBoard::CELLS,
+              "line walks and vector loads must stay inside the padded board");
+
+void BatchPlayout::findNear() {
+    for (int i = FIRST - PaddedBoard::STRIDE; i < LAST + PaddedBoard::STRIDE; i++) {
+        rowNear[i] = stones[0][i - 1] | stones[1][i - 1] | stones[0][i] | stones[1][i] |
+                     stones[0][i + 1] | stones[1][i + 1];
+    }
+    for (int i = FIRST; i < LAST; i++) {
+        near[i] = rowNear[i - PaddedBoard::STRIDE] | rowNear[i] | rowNear[i + PaddedBoard::STRIDE];
+    }
+}
+
+int BatchPlayout::randomCell(int lane) {
+    const auto& cells = boardCells();
+    for (int i = 0; i < RANDOM_TRIES; i++) {
+        uint64_t r = nextRandom();
+        int cell = cells[((r & 0xFFFFFFFF) * cells.size()) >> 32];
+        if (((near[cell] & empty[cell]) >> lane) & 1) return cell;
+    }
+    for (int cell : cells) {
+        if ((empty[cell] >> lane) & 1) return cell;
+    }
+    return -1;
+}
+
+BatchPlayout::Results BatchPlayout::run(uint64_t seed, int maxPlies) {
+    rngState = seed | 1;
+    Results results;
+    Lanes active = ~Lanes(0);
+    fiveCells(stones[side - 1].data(), empty.data(), wins.data());
+
+    for (int ply = 0; ply < maxPlies && emptyCells > 0; ply++) {
+        Lanes winning = 0;
+        for (int i = FIRST; i < LAST; i++) {
+            winning |= wins[i] & empty[i];
+        }
+        winning &= active;
+        (side == PaddedBoard::BLACK ? results.blackWins : results.whiteWins) |= winning;
+        active &= ~winning;
+        if (!active) break;
+
+        // Block the opponent's five where there is one, first cell first
+        fiveCells(stones[2 - side].data(), empty.data(), threats.data());
+        Lanes pending = active;
+        for (int i = FIRST; i < LAST && pending; i++) {
+            if (Lanes block = threats[i] & pending) {
+                place(i, block);
+                pending &= ~block;
+            }
+        }
+        if (pending) {
+            findNear();
+            for (Lanes rest = pending; rest; rest &= rest - 1) {
+                int lane = Bitboard::lowestBit(rest);
+                place(randomCell(lane), Lanes(1) << lane);
+            }
+        }
+
+        results.plies = ply + 1;
+        wins.swap(threats);
+        side = 3 - side;
+        emptyCells--;
+    }
+    return results;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,90 @@
+// batch_playout.h - Bit-sliced playouts of libgomoku, 64 games per machine word
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "padded_board.h"
+
+namespace gomoku {
+
+// Plays 64 games in lockstep from one position, one game per bit of a
+// 64-bit word (a lane). Every cell holds three words: the lanes with a
+// black stone there, the lanes with a white stone and the lanes where it is
+// empty. Cells are laid out like PaddedBoard, and border cells are in none
+// of the three, so no line runs past the edge.
+//
+// Each ply, a bitwise pass over the board finds, for all lanes at once, the
+// cells where the opponent of the side to move would complete five. Games
+// with a five of their own to make end as wins. Games facing a five block
+// it, and the rest play a random empty cell next to a stone. Only that
+// random choice is made lane by lane. The opponent's five cells are the
+// side to move's on the next ply, less the cells just filled, so one pass
+// per ply serves both. The pass handles four cells per instruction when
+// the processor has AVX2.
+class BatchPlayout {
+public:
+    static constexpr int LANES = 64;
+    using Lanes = uint64_t;
+
+    // Lanes in neither mask were drawn
+    struct Results {
+        Lanes blackWins = 0;
+        Lanes whiteWins = 0;
+        int plies = 0;  // moves of the longest game
+    };
+
+    // Every lane starts from board with side (PaddedBoard::BLACK or WHITE)
+    // to move
+    void reset(const PaddedBoard& board, int side);
+
+    // Plays every game to a five, a full board or maxPlies moves
+    Results run(uint64_t seed, int maxPlies);
+
+    // For every cell, the lanes where a stone of own there completes five:
+    // the cell is empty and, along some direction, four own stones lie
+    // around it in one window of five. Words are indexed like the board
+    // (PaddedBoard::index).
+    static void fiveCells(const Lanes* own, const Lanes* empty, Lanes* out);
+    static void fiveCellsScalar(const Lanes* own, const Lanes* empty, Lanes* out);
+    static void fiveCellsAvx2(const Lanes* own, const Lanes* empty, Lanes* out);
+
+private:
+    using Words = std::array<Lanes, PaddedBoard::CELLS>;
+
+    // Cells from the top-left to the bottom-right board cell
+    static constexpr int FIRST = PaddedBoard::index(0, 0);
+    static constexpr int LAST = PaddedBoard::index(PaddedBoard::SIZE - 1, PaddedBoard::SIZE - 1) + 1;
+    static constexpr int RANDOM_TRIES = 64;  // samples before a full scan for a free cell
+
+    void place(int cell, Lanes lanes) {
+        stones[side - 1][cell] |= lanes;
+        empty[cell] &= ~lanes;
+    }
+
+    // Lanes with a stone among the eight neighbours of each cell
+    void findNear();
+
+    // Random cell next to a stone in lane, or any empty one when sampling
+    // misses
+    int randomCell(int lane);
+
+    uint64_t nextRandom() {
+        rngState ^= rngState >> 12;
+        rngState ^= rngState << 25;
+        rngState ^= rngState >> 27;
+        return rngState * 0x2545F4914F6CDD1DULL;
+    }
+
+    alignas(64) Words stones[2];  // black, white
+    alignas(64) Words empty;
+    alignas(64) Words wins;       // five cells of the side to move
+    alignas(64) Words threats;    // five cells of its opponent
+    alignas(64) Words rowNear;
+    alignas(64) Words near;
+    int side = PaddedBoard::BLACK;
+    int emptyCells = 0;
+    uint64_t rngState = 1;
+};
+
+}  // namespace gomoku
@@ -0,0 +1,17 @@
+// board.cpp - Line-shape score table of libgomoku
+#include "board.h"
+
+namespace gomoku {
+
+int LineEvaluator::scoreLine(uint32_t own, uint32_t opponent, uint32_t valid) {
+    int score = 0;
+    for (uint32_t rest = own; rest; rest &= rest - 1) {
+        score += LINE_SCORES[lineKey(own, opponent, valid, Bitboard::lowestBit(rest))];
+    }
+    return score;
+}
+
+const std::array<int, LinePatterns::KEY_COUNT> LineEvaluator::LINE_SCORES =
+    LinePatterns::build<int>(LineEvaluator::scoreWindow);
+
+}  // namespace gomoku
@@ -0,0 +1,575 @@
+// board.h - Board, move generation and static evaluation of libgomoku
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "zobrist.h"
+#include "patterns.h"
+
+namespace gomoku {
+
+constexpr int BOARD_SIZE = 15;
+constexpr int WIN_LENGTH = 5;
+constexpr int MAX_DEPTH = 8;
+constexpr int MAX_PLY = 64;  // hard limit for iterative deepening
+constexpr int INFINITY_SCORE = 1000000;
+constexpr int WIN_SCORE = 100000;
+constexpr int WIN_THRESHOLD = WIN_SCORE - 1000;  // scores beyond this are forced wins/losses
+
+static_assert(BOARD_SIZE * BOARD_SIZE == Zobrist::BOARD_CELLS, "Zobrist keys assume a 15x15 board");
+static_assert(WIN_LENGTH == LinePatterns::SPAN, "line pattern tables assume five in a row");
+
+enum class Stone { EMPTY = 0, BLACK = 1, WHITE = 2 };
+enum class GameStatus { ONGOING, BLACK_WIN, WHITE_WIN, DRAW };
+
+// Direction vectors for checking lines
+inline const std::vector<std::pair<int, int>> DIRECTIONS = {
+    {0, 1},   // Horizontal
+    {1, 0},   // Vertical
+    {1, 1},   // Diagonal (down-right)
+    {1, -1}   // Diagonal (down-left)
+};
+
+// Pattern scores for evaluation
+struct PatternScore {
+    static constexpr int FIVE = 100000;
+    static constexpr int OPEN_FOUR = 10000;
+    static constexpr int BLOCKED_FOUR = 1000;
+    static constexpr int OPEN_THREE = 1000;
+    static constexpr int BLOCKED_THREE = 100;
+    static constexpr int OPEN_TWO = 100;
+    static constexpr int BLOCKED_TWO = 10;
+    static constexpr int ONE = 1;
+};
+
+class Position {
+public:
+    int row, col;
+    Position(int r = 0, int c = 0) : row(r), col(c) {}
+    bool isValid() const { 
+        return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE; 
+    }
+    bool operator==(const Position& other) const {
+        return row == other.row && col == other.col;
+    }
+};
+
+// Fixed-capacity move list. The search keeps one per ply in a preallocated
+// stack, so generating and ordering moves never touches the heap.
+class MoveList {
+public:
+    // Every cell, plus room for a promoted hash move
+    static constexpr int CAPACITY = BOARD_SIZE * BOARD_SIZE + 1;
+    
+    MoveList() : count(0) {}
+    
+    void clear() { count = 0; }
+    void push_back(const Position& move) { moves[count++] = move; }
+    
+    // Inserts move in front of the others, keeping their order
+    void push_front(const Position& move) {
+        std::copy_backward(begin(), end(), end() + 1);
+        moves[0] = move;
+        count++;
+    }
+    
+    // Keeps the first n moves
+    void truncate(int n) { count = std::min(count, n); }
+    
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    Position& operator[](int i) { return moves[i]; }
+    const Position& operator[](int i) const { return moves[i]; }
+    
+    Position* begin() { return moves.data(); }
+    Position* end() { return moves.data() + count; }
+    const Position* begin() const { return moves.data(); }
+    const Position* end() const { return moves.data() + count; }
+    
+private:
+    std::array<Position, CAPACITY> moves;
+    int count;
+};
+
+// 256-bit board mask. Cell (r, c) lives at bit r * STRIDE + c. Column 15 of every
+// row and the whole of row 15 are guard bits that always stay zero, so shifting
+// by 1, 16, 17 or 15 steps a stone along a row, column or diagonal without
+// wrapping into the neighbouring row.
+class Bitboard {
+public:
+    static constexpr int STRIDE = 16;
+    static constexpr int WORDS = 4;
+    
+    std::array<uint64_t, WORDS> words{};
+    
+    static constexpr int bitIndex(int row, int col) { return row * STRIDE + col; }
+    
+    static int lowestBit(uint64_t x) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+    
+    static int popcount(uint64_t x) {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt64(x));
+#else
+        return __builtin_popcountll(x);
+#endif
+    }
+    
+    // All 225 playable cells
+    static const Bitboard& boardMask() {
+        static const Bitboard mask = [] {
+            Bitboard b;
+            for (int r = 0; r < BOARD_SIZE; r++) {
+                for (int c = 0; c < BOARD_SIZE; c++) {
+                    b.set(bitIndex(r, c));
+                }
+            }
+            return b;
+        }();
+        return mask;
+    }
+    
+    bool test(int bit) const { return (words[bit >> 6] >> (bit & 63)) & 1; }
+    void set(int bit) { words[bit >> 6] |= uint64_t(1) << (bit & 63); }
+    void reset(int bit) { words[bit >> 6] &= ~(uint64_t(1) << (bit & 63)); }
+    
+    bool any() const { return (words[0] | words[1] | words[2] | words[3]) != 0; }
+    
+    int count() const {
+        return popcount(words[0]) + popcount(words[1]) + popcount(words[2]) + popcount(words[3]);
+    }
+    
+    Bitboard operator&(const Bitboard& o) const {
+        Bitboard r;
+        for (int i = 0; i < WORDS; i++) r.words[i] = words[i] & o.words[i];
+        return r;
+    }
+    
+    Bitboard operator|(const Bitboard& o) const {
+        Bitboard r;
+        for (int i = 0; i < WORDS; i++) r.words[i] = words[i] | o.words[i];
+        return r;
+    }
+    
+    // Complement restricted to playable cells, so guard bits stay clear
+    Bitboard operator~() const {
+        Bitboard r;
+        const Bitboard& mask = boardMask();
+        for (int i = 0; i < WORDS; i++) r.words[i] = ~words[i] & mask.words[i];
+        return r;
+    }
+    
+    // Shift towards higher bit indices (0 < n < 64)
+    Bitboard shiftUp(int n) const {
+        Bitboard r;
+        r.words[0] = words[0] << n;
+        for (int i = 1; i < WORDS; i++) {
+            r.words[i] = (words[i] << n) | (words[i - 1] >> (64 - n));
+        }
+        return r;
+    }
+    
+    // Shift towards lower bit indices (0 < n < 64)
+    Bitboard shiftDown(int n) const {
+        Bitboard r;
+        for (int i = 0; i < WORDS - 1; i++) {
+            r.words[i] = (words[i] >> n) | (words[i + 1] << (64 - n));
+        }
+        r.words[WORDS - 1] = words[WORDS - 1] >> n;
+        return r;
+    }
+    
+    // Grow every set cell into its 3x3 neighbourhood
+    Bitboard dilate() const {
+        const Bitboard& mask = boardMask();
+        Bitboard h = *this | ((shiftUp(1) | shiftDown(1)) & mask);
+        return h | ((h.shiftUp(STRIDE) | h.shiftDown(STRIDE)) & mask);
+    }
+    
+    template <typename F>
+    void forEach(F&& f) const {
+        for (int i = 0; i < WORDS; i++) {
+            uint64_t w = words[i];
+            while (w) {
+                int bit = i * 64 + lowestBit(w);
+                f(bit / STRIDE, bit % STRIDE);
+                w &= w - 1;
+            }
+        }
+    }
+};
+
+// Scores one line (row, column or diagonal) from its 16-bit stone masks.
+// Every stone contributes the shape it sits in along the line, so the sum
+// over all lines equals the full-board pattern scan and a move only changes
+// the four lines through it. Shapes are looked up by their 9-cell window.
+class LineEvaluator {
+public:
+    struct LinePattern {
+        int consecutive;
+        int openEnds;
+        int gaps;
+    };
+    
+    static int getPatternScore(const LinePattern& pattern) {
+        if (pattern.consecutive >= 5) return PatternScore::FIVE;
+        if (pattern.consecutive == 4) {
+            if (pattern.openEnds == 2) return PatternScore::OPEN_FOUR;
+            if (pattern.openEnds == 1) return PatternScore::BLOCKED_FOUR;
+        }
+        if (pattern.consecutive == 3) {
+            if (pattern.openEnds == 2) return PatternScore::OPEN_THREE;
+            if (pattern.openEnds == 1) return PatternScore::BLOCKED_THREE;
+        }
+        if (pattern.consecutive == 2) {
+            if (pattern.openEnds == 2) return PatternScore::OPEN_TWO;
+            if (pattern.openEnds == 1) return PatternScore::BLOCKED_TWO;
+        }
+        if (pattern.consecutive == 1 && pattern.openEnds > 0) return PatternScore::ONE;
+        return 0;
+    }
+    
+    // Shape of the centre stone; opponent stones and the board edge end the
+    // scan without counting as an open end
+    static LinePattern analyze(const LinePatterns::Window& window) {
+        LinePattern pattern = {1, 0, 0};
+        
+        for (int dir = -1; dir <= 1; dir += 2) {
+            int count = 0;
+            int gapCount = 0;
+            
+            for (int i = 1; i < WIN_LENGTH; i++) {
+                LinePatterns::Cell cell = window[LinePatterns::REACH + i * dir];
+                if (cell == LinePatterns::OPPONENT || cell == LinePatterns::EDGE) break;
+                
+                if (cell == LinePatterns::OWN) {
+                    count++;
+                    if (gapCount > 0) pattern.gaps++;
+                    gapCount = 0;
+                } else if (count > 0 && gapCount == 0) {
+                    gapCount++;
+                } else {
+                    pattern.openEnds++;
+                    break;
+                }
+            }
+            
+            pattern.consecutive += count;
+        }
+        
+        return pattern;
+    }
+    
+    // Neighbour key of bit pos; valid marks the cells of the line that lie
+    // on the board
+    static int lineKey(uint32_t own, uint32_t opponent, uint32_t valid, int pos) {
+        // Pad by REACH cells on each side, marking off-board cells in both masks
+        uint32_t edge = ~(valid << LinePatterns::REACH);
+        uint32_t mine = ((own << LinePatterns::REACH) | edge) >> pos;
+        uint32_t theirs = ((opponent << LinePatterns::REACH) | edge) >> pos;
+        return LinePatterns::keyFromMasks((mine & 0xF) | ((mine >> 1) & 0xF0),
+                                          (theirs & 0xF) | ((theirs >> 1) & 0xF0));
+    }
+    
+    // Sum of the shape scores of the own stones on the line
+    static int scoreLine(uint32_t own, uint32_t opponent, uint32_t valid);
+    
+private:
+    static int scoreWindow(const LinePatterns::Window& window) {
+        return getPatternScore(analyze(window));
+    }
+    
+    static const std::array<int, LinePatterns::KEY_COUNT> LINE_SCORES;
+};
+
+class Board {
+private:
+    static constexpr int LINE_COUNT = 2 * BOARD_SIZE - 1;
+    
+    // stones[0] holds black, stones[1] white
+    std::array<Bitboard, 2> stones;
+    // Per-direction copies of the same stones, one 16-bit mask per line,
+    // indexed like DIRECTIONS (row, column, diagonal, anti-diagonal)
+    std::array<std::array<std::array<uint16_t, LINE_COUNT>, 4>, 2> lines;
+    std::vector<Position> moveHistory;
+    int moveCount;
+    // Updated on every placeStone/removeStone from the lines through that
+    // stone only; decidedAt is the move count at which the game ended
+    GameStatus status;
+    int decidedAt;
+    uint64_t hash;
+    // Incremental evaluation: pattern score of every line for each colour,
+    // rescored only for the four lines through a changed cell, plus the
+    // centre bonus of every stone
+    std::array<std::array<std::array<int, LINE_COUNT>, 4>, 2> lineScores;
+    std::array<int, 2> patternTotal;
+    std::array<int, 2> centerTotal;
+    // Candidate moves: how many stones lie within NEAR_RANGE of each cell,
+    // and the cells where that count is non-zero, adjusted around the
+    // changed cell on every placeStone/removeStone
+    std::array<uint8_t, BOARD_SIZE * BOARD_SIZE> nearCount;
+    Bitboard nearStones;
+    
+    static int colorIndex(Stone stone) { return static_cast<int>(stone) - 1; }
+    
+    static int lineIndex(int dir, int row, int col) {
+        switch (dir) {
+            case 0: return row;
+            case 1: return col;
+            case 2: return row - col + BOARD_SIZE - 1;
+            default: return row + col;
+        }
+    }
+    
+    // Bit position along the line; consecutive cells differ by one
+    static int linePos(int dir, int row, int col) {
+        return dir == 1 ? row : col;
+    }
+    
+    static bool hasFiveInLine(uint32_t line) {
+        return (line & (line >> 1) & (line >> 2) & (line >> 3) & (line >> 4)) != 0;
+    }
+    
+    // Cells of a line that are on the board
+    static uint32_t lineMask(int dir, int index) {
+        int lo = 0;
+        int hi = BOARD_SIZE - 1;
+        if (dir == 2) {
+            int d = index - (BOARD_SIZE - 1);
+            lo = std::max(0, -d);
+            hi = std::min(BOARD_SIZE - 1, BOARD_SIZE - 1 - d);
+        } else if (dir == 3) {
+            lo = std::max(0, index - (BOARD_SIZE - 1));
+            hi = std::min(BOARD_SIZE - 1, index);
+        }
+        return ((2u << hi) - 1) & ~((1u << lo) - 1);
+    }
+    
+    static int centerBonus(int row, int col) {
+        return BOARD_SIZE - (std::abs(row - BOARD_SIZE / 2) + std::abs(col - BOARD_SIZE / 2));
+    }
+    
+    void toggleLines(int color, int row, int col) {
+        for (int dir = 0; dir < 4; dir++) {
+            lines[color][dir][lineIndex(dir, row, col)] ^= uint16_t(1u << linePos(dir, row, col));
+        }
+    }
+    
+    void updateNear(int row, int col, int delta) {
+        for (int r = std::max(0, row - NEAR_RANGE); r <= std::min(BOARD_SIZE - 1, row + NEAR_RANGE); r++) {
+            for (int c = std::max(0, col - NEAR_RANGE); c <= std::min(BOARD_SIZE - 1, col + NEAR_RANGE); c++) {
+                uint8_t& count = nearCount[r * BOARD_SIZE + c];
+                count += delta;
+                if (count == 0) {
+                    nearStones.reset(Bitboard::bitIndex(r, c));
+                } else {
+                    nearStones.set(Bitboard::bitIndex(r, c));
+                }
+            }
+        }
+    }
+    
+    void rescoreLines(int row, int col) {
+        for (int dir = 0; dir < 4; dir++) {
+            int index = lineIndex(dir, row, col);
+            uint32_t valid = lineMask(dir, index);
+            for (int color = 0; color < 2; color++) {
+                int score = LineEvaluator::scoreLine(lines[color][dir][index],
+                                                     lines[1 - color][dir][index], valid);
+                patternTotal[color] += score - lineScores[color][dir][index];
+                lineScores[color][dir][index] = score;
+            }
+        }
+    }
+    
+public:
+    // Moves are generated within this many cells of a stone
+    static constexpr int NEAR_RANGE = 2;
+    
+    Board() : lines{}, moveCount(0), status(GameStatus::ONGOING), decidedAt(0), hash(0),
+              lineScores{}, patternTotal{}, centerTotal{}, nearCount{} {
+        moveHistory.reserve(BOARD_SIZE * BOARD_SIZE);
+    }
+    
+    // Copies keep room for a full game too (assignment reuses the reserved
+    // history), so a search board never reallocates
+    Board(const Board& other) : Board() { *this = other; }
+    Board& operator=(const Board& other) = default;
+    
+    Stone getStone(int row, int col) const {
+        if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE) {
+            return Stone::EMPTY;
+        }
+        int bit = Bitboard::bitIndex(row, col);
+        if (stones[0].test(bit)) return Stone::BLACK;
+        if (stones[1].test(bit)) return Stone::WHITE;
+        return Stone::EMPTY;
+    }
+    
+    bool placeStone(int row, int col, Stone stone) {
+        if (!isValidMove(row, col)) return false;
+        int color = colorIndex(stone);
+        stones[color].set(Bitboard::bitIndex(row, col));
+        toggleLines(color, row, col);
+        hash ^= Zobrist::stone(color, row * BOARD_SIZE + col);
+        rescoreLines(row, col);
+        centerTotal[color] += centerBonus(row, col);
+        updateNear(row, col, 1);
+        moveHistory.push_back(Position(row, col));
+        moveCount++;
+        
+        if (status == GameStatus::ONGOING) {
+            if (hasFiveThrough(row, col, stone)) {
+                status = (stone == Stone::BLACK) ? GameStatus::BLACK_WIN : GameStatus::WHITE_WIN;
+                decidedAt = moveCount;
+            } else if (isFull()) {
+                status = GameStatus::DRAW;
+                decidedAt = moveCount;
+            }
+        }
+        return true;
+    }
+    
+    void removeStone(int row, int col) {
+        Stone stone = getStone(row, col);
+        if (stone != Stone::EMPTY) {
+            int color = colorIndex(stone);
+            stones[color].reset(Bitboard::bitIndex(row, col));
+            toggleLines(color, row, col);
+            hash ^= Zobrist::stone(color, row * BOARD_SIZE + col);
+            rescoreLines(row, col);
+            centerTotal[color] -= centerBonus(row, col);
+            updateNear(row, col, -1);
+        }
+        if (!moveHistory.empty()) {
+            if (moveCount == decidedAt) {
+                status = GameStatus::ONGOING;
+                decidedAt = 0;
+            }
+            moveHistory.pop_back();
+            moveCount--;
+        }
+    }
+    
+    bool isValidMove(int row, int col) const {
+        return row >= 0 && row < BOARD_SIZE && 
+               col >= 0 && col < BOARD_SIZE && 
+               !occupied().test(Bitboard::bitIndex(row, col));
+    }
+    
+    // Black moves first
+    Stone sideToMove() const {
+        return moveCount % 2 == 0 ? Stone::BLACK : Stone::WHITE;
+    }
+    
+    bool isFull() const {
+        return moveCount >= BOARD_SIZE * BOARD_SIZE;
+    }
+    
+    Bitboard occupied() const { return stones[0] | stones[1]; }
+    
+    // Zobrist key of the stones on the board, updated incrementally
+    uint64_t getHash() const { return hash; }
+    
+    // Static evaluation from stone's point of view, kept as a running total
+    int evaluate(Stone stone) const {
+        int me = colorIndex(stone);
+        return (patternTotal[me] + centerTotal[me]) - (patternTotal[1 - me] + centerTotal[1 - me]);
+    }
+    
+    const Bitboard& getStones(Stone stone) const { return stones[colorIndex(stone)]; }
+    
+    // Stones of one colour along the line through (row, col) in direction dir
+    uint16_t getLine(Stone stone, int dir, int row, int col) const {
+        return lines[colorIndex(stone)][dir][lineIndex(dir, row, col)];
+    }
+    
+    // Threat class of a stone at (row, col) along direction dir, whether or
+    // not the cell is occupied
+    LinePatterns::Threat getThreat(int row, int col, Stone stone, int dir) const {
+        int me = colorIndex(stone);
+        int index = lineIndex(dir, row, col);
+        int key = LineEvaluator::lineKey(lines[me][dir][index], lines[1 - me][dir][index],
+                                         lineMask(dir, index), linePos(dir, row, col));
+        return LinePatterns::threat(key);
+    }
+    
+    // True if playing stone at the empty cell (row, col) completes five
+    bool makesFive(int row, int col, Stone stone) const {
+        for (int dir = 0; dir < 4; dir++) {
+            uint32_t line = getLine(stone, dir, row, col) | (1u << linePos(dir, row, col));
+            if (hasFiveInLine(line)) return true;
+        }
+        return false;
+    }
+    
+    // True if the stone at (row, col) is part of five in a row
+    bool hasFiveThrough(int row, int col, Stone stone) const {
+        for (int dir = 0; dir < 4; dir++) {
+            if (hasFiveInLine(getLine(stone, dir, row, col))) return true;
+        }
+        return false;
+    }
+    
+    std::vector<Position> getEmptyPositions() const {
+        std::vector<Position> empty;
+        (~occupied()).forEach([&](int r, int c) { empty.emplace_back(r, c); });
+        return empty;
+    }
+    
+    // Empty cells within NEAR_RANGE of a stone, read from the maintained set
+    void getRelevantMoves(MoveList& moves) const {
+        moves.clear();
+        
+        // If board is empty, start from center
+        if (moveCount == 0) {
+            moves.push_back(Position(BOARD_SIZE / 2, BOARD_SIZE / 2));
+            return;
+        }
+        
+        (nearStones & ~occupied()).forEach([&](int r, int c) { moves.push_back(Position(r, c)); });
+    }
+    
+    // O(1): the status is kept up to date by placeStone/removeStone
+    GameStatus checkWin() const {
+        return status;
+    }
+    
+    const std::vector<Position>& getMoveHistory() const { return moveHistory; }
+};
+
+class PatternEvaluator {
+public:
+    // O(1): Board keeps the per-line pattern scores up to date
+    static int evaluatePosition(const Board& board, Stone stone) {
+        return board.evaluate(stone);
+    }
+    
+    // True if playing stone at pos makes a four or an open three
+    static bool isThreat(const Board& board, Position pos, Stone stone) {
+        for (int dir = 0; dir < 4; dir++) {
+            if (board.getThreat(pos.row, pos.col, stone, dir) >= LinePatterns::SPLIT_THREE) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace gomoku
@@ -0,0 +1,334 @@
+// dfpn.cpp - Depth-first proof-number solver of libgomoku
+#include "dfpn.h"
+
+#include <algorithm>
+
+#include "threat_solver.h"
+
+namespace gomoku {
+
+namespace {
+
+constexpr uint64_t WHITE_ATTACKS = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t ATTACKS_KEYS[] = {0x2545F4914F6CDD1DULL, 0xD1B54A32D192ED03ULL, 0x8CB92BA72F3D8DD7ULL};
+constexpr uint64_t LAST_MOVE = 0xA0761D6478BD642FULL;
+
+}  // namespace
+
+ProofSolver::ProofSolver(size_t tableMegabytes)
+    : tableMask(0), attacker(Stone::BLACK), attacks(Attacks::THREATS), nodes(0), nodeLimit(0), aborted(false) {
+    setTableSize(tableMegabytes);
+}
+
+void ProofSolver::setTableSize(size_t megabytes) {
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) {
+        count *= 2;
+    }
+    table.assign(count, Bucket());
+    tableMask = count - 1;
+}
+
+void ProofSolver::clear() { std::fill(table.begin(), table.end(), Bucket()); }
+
+uint64_t ProofSolver::key(uint64_t stonesHash, bool attackerToMove, Position move) const {
+    uint64_t k = stonesHash ^ ATTACKS_KEYS[static_cast<int>(attacks)];
+    if (attacker == Stone::WHITE) k ^= WHITE_ATTACKS;
+    if (!attackerToMove) {
+        k ^= Zobrist::sideToMove();
+        if (attacks != Attacks::ALL && move.isValid()) k ^= LAST_MOVE * static_cast<uint64_t>(move.row * BOARD_SIZE + move.col + 1);
+    }
+    return k;
+}
+
+const ProofSolver::Entry* ProofSolver::probe(uint64_t k) const {
+    const Bucket& bucket = table[k & tableMask];
+    for (const Entry& entry : bucket.entries) {
+        if (entry.key == k) return &entry;
+    }
+    return nullptr;
+}
+
+void ProofSolver::store(uint64_t k, uint32_t proof, uint32_t disproof, uint32_t work) {
+    Bucket& bucket = table[k & tableMask];
+    Entry* slot = &bucket.entries[0];
+    for (Entry& entry : bucket.entries) {
+        if (entry.key == k) {
+            slot = &entry;
+            work = std::max(work, entry.work);
+            break;
+        }
+        if (entry.work < slot->work) slot = &entry;
+    }
+    slot->key = k;
+    slot->proof = proof;
+    slot->disproof = disproof;
+    slot->work = work;
+}
+
+bool ProofSolver::generate(const Board& board, Position last, MoveList& moves, uint32_t& proof, uint32_t& disproof) const {
+    Stone mover = board.sideToMove();
+    Stone opponent = other(mover);
+    bool attackerToMove = mover == attacker;
+    // Numbers of a win and of a loss for the side to move
+    uint32_t winProof = attackerToMove ? 0 : INFINITE;
+    uint32_t winDisproof = attackerToMove ? INFINITE : 0;
+    Position fives[2];
+    
+    moves.clear();
+    if (ThreatSolver::fiveCells(board, mover, ThreatSolver::near(board, mover, 1), fives) > 0) {
+        proof = winProof;
+        disproof = winDisproof;
+        return false;
+    }
+    int opponentFives = ThreatSolver::fiveCells(board, opponent, ThreatSolver::near(board, opponent, 1), fives);
+    if (opponentFives > 1) {
+        proof = winDisproof;
+        disproof = winProof;
+        return false;
+    }
+    
+    LinePatterns::Threat minimum = attacks == Attacks::FOURS ? LinePatterns::FOUR : LinePatterns::SPLIT_THREE;
+    if (opponentFives == 1) {
+        // Forced block; under threat restriction the attacker's block must
+        // itself be an allowed attack
+        if (!attackerToMove || attacks == Attacks::ALL ||
+            ThreatSolver::bestThreat(board, fives[0].row, fives[0].col, attacker) >= minimum) {
+            moves.push_back(fives[0]);
+        }
+    } else if (attacks == Attacks::ALL) {
+        board.getRelevantMoves(moves);
+        if (!attackerToMove) {
+            // The defender also gets the cells beyond the candidate area that
+            // share a five with a stone, up to four away along its lines
+            Bitboard listed = board.occupied();
+            for (const auto& move : moves) listed.set(Bitboard::bitIndex(move.row, move.col));
+            board.occupied().forEach([&](int row, int col) {
+                for (auto [dr, dc] : DIRECTIONS) {
+                    for (int k = -(WIN_LENGTH - 1); k <= WIN_LENGTH - 1; k++) {
+                        int r = row + k * dr;
+                        int c = col + k * dc;
+                        if (board.isValidMove(r, c) && !listed.test(Bitboard::bitIndex(r, c))) {
+                            listed.set(Bitboard::bitIndex(r, c));
+                            moves.push_back(Position(r, c));
+                        }
+                    }
+                }
+            });
+        }
+    } else if (attackerToMove) {
+        // Fours first: they settle fastest
+        Bitboard area = ThreatSolver::near(board, attacker, 2);
+        MoveList threes;
+        area.forEach([&](int r, int c) {
+            LinePatterns::Threat threat = ThreatSolver::bestThreat(board, r, c, attacker);
+            if (threat >= LinePatterns::FOUR) moves.push_back(Position(r, c));
+            else if (threat >= minimum) threes.push_back(Position(r, c));
+        });
+        for (const auto& move : threes) moves.push_back(move);
+    } else if (last.isValid()) {
+        // Defences to the three just made: every empty cell along the
+        // threatened lines, and any four the defender can make instead
+        for (int dir = 0; dir < 4; dir++) {
+            if (board.getThreat(last.row, last.col, attacker, dir) < LinePatterns::SPLIT_THREE) continue;
+            auto [dr, dc] = DIRECTIONS[dir];
+            for (int k = -4; k <= 4; k++) {
+                int r = last.row + k * dr;
+                int c = last.col + k * dc;
+                if (board.isValidMove(r, c) && std::find(moves.begin(), moves.end(), Position(r, c)) == moves.end()) {
+                    moves.push_back(Position(r, c));
+                }
+            }
+        }
+        ThreatSolver::near(board, mover, 2).forEach([&](int r, int c) {
+            if (ThreatSolver::bestThreat(board, r, c, mover) >= LinePatterns::FOUR &&
+                std::find(moves.begin(), moves.end(), Position(r, c)) == moves.end()) {
+                moves.push_back(Position(r, c));
+            }
+        });
+    }
+    
+    // No allowed attack, no threat left to answer, or a full board: the
+    // attacker has not won
+    if (moves.empty()) {
+        proof = INFINITE;
+        disproof = 0;
+        return false;
+    }
+    return true;
+}
+
+bool ProofSolver::outOfTime() {
+    if ((nodeLimit > 0 && nodes >= nodeLimit) ||
+        ((nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline)) {
+        aborted = true;
+    }
+    return aborted;
+}
+
+// Multiple-iterative deepening (MID): expand the most-proving child while
+// the node's numbers stay under the thresholds, handing the child
+// thresholds that send the search back here as soon as a sibling would be
+// the better choice
+void ProofSolver::mid(Board& board, Position last, uint32_t proofThreshold, uint32_t disproofThreshold) {
+    nodes++;
+    if (outOfTime()) return;
+    long long startNodes = nodes;
+    
+    Stone mover = board.sideToMove();
+    bool attackerToMove = mover == attacker;
+    int color = mover == Stone::BLACK ? 0 : 1;
+    uint64_t hash = board.getHash();
+    uint64_t nodeKey = key(hash, attackerToMove, last);
+    
+    MoveList moves;
+    uint32_t proof, disproof;
+    if (!generate(board, last, moves, proof, disproof)) {
+        store(nodeKey, proof, disproof, 1);
+        return;
+    }
+    
+    for (;;) {
+        // The attacker needs one proven child, the defender all of them:
+        // attacker nodes take the least proof number and the sum of
+        // disproof numbers, defender nodes the other way round
+        uint32_t selected = INFINITE + 1;
+        uint32_t second = INFINITE;
+        uint32_t total = 0;
+        int best = 0;
+        uint32_t bestProof = 1, bestDisproof = 1;
+        for (int i = 0; i < moves.size(); i++) {
+            const Position& move = moves[i];
+            const Entry* entry = probe(key(hash ^ Zobrist::stone(color, move.row * BOARD_SIZE + move.col), !attackerToMove, move));
+            uint32_t childProof = entry ? entry->proof : 1;
+            uint32_t childDisproof = entry ? entry->disproof : 1;
+            uint32_t chosen = attackerToMove ? childProof : childDisproof;
+            total = add(total, attackerToMove ? childDisproof : childProof);
+            if (chosen < selected) {
+                second = selected;
+                selected = chosen;
+                best = i;
+                bestProof = childProof;
+                bestDisproof = childDisproof;
+            } else if (chosen < second) {
+                second = chosen;
+            }
+        }
+        proof = attackerToMove ? selected : total;
+        disproof = attackerToMove ? total : selected;
+        store(nodeKey, proof, disproof, static_cast<uint32_t>(std::min<long long>(nodes - startNodes + 1, INFINITE)));
+        if (proof >= proofThreshold || disproof >= disproofThreshold || aborted) return;
+        
+        uint32_t childProofThreshold, childDisproofThreshold;
+        if (attackerToMove) {
+            childProofThreshold = std::min(proofThreshold, add(second, 1));
+            childDisproofThreshold = static_cast<uint32_t>(
+                std::min<uint64_t>(uint64_t(disproofThreshold) - disproof + bestDisproof, INFINITE));
+        } else {
+            childDisproofThreshold = std::min(disproofThreshold, add(second, 1));
+            childProofThreshold = static_cast<uint32_t>(
+                std::min<uint64_t>(uint64_t(proofThreshold) - proof + bestProof, INFINITE));
+        }
+        
+        const Position move = moves[best];
+        board.placeStone(move.row, move.col, mover);
+        mid(board, move, childProofThreshold, childDisproofThreshold);
+        board.removeStone(move.row, move.col);
+    }
+}
+
+void ProofSolver::settle(Board& board, Position last) {
+    uint64_t nodeKey = key(board.getHash(), board.sideToMove() == attacker, last);
+    for (;;) {
+        const Entry* entry = probe(nodeKey);
+        if ((entry && (entry->proof == 0 || entry->disproof == 0)) || aborted) return;
+        mid(board, last, INFINITE, INFINITE);
+    }
+}
+
+// Follows proven children from the table, searching again any that were
+// replaced since, for depth plies
+void ProofSolver::buildProof(Board& board, Position last, int depth, std::vector<ProofNode>& proof) {
+    Stone mover = board.sideToMove();
+    bool attackerToMove = mover == attacker;
+    int color = mover == Stone::BLACK ? 0 : 1;
+    MoveList moves;
+    uint32_t proofNumber, disproofNumber;
+    if (!generate(board, last, moves, proofNumber, disproofNumber)) {
+        // Settled at once: the attacker's five, or two fives the defender
+        // cannot both stop
+        Position fives[2];
+        if (attackerToMove && ThreatSolver::fiveCells(board, attacker, ThreatSolver::near(board, attacker, 1), fives) > 0) {
+            proof.push_back(ProofNode{fives[0], {}});
+        }
+        return;
+    }
+    
+    auto childKey = [&](const Position& move) {
+        return key(board.getHash() ^ Zobrist::stone(color, move.row * BOARD_SIZE + move.col), !attackerToMove, move);
+    };
+    auto proven = [&](const Position& move) {
+        const Entry* entry = probe(childKey(move));
+        return entry && entry->proof == 0;
+    };
+    
+    // The attacker needs one winning move: one the table still proves, or
+    // else the first that proves again
+    if (attackerToMove) {
+        const Position* win = std::find_if(moves.begin(), moves.end(), proven);
+        for (auto move = moves.begin(); win == moves.end() && move != moves.end() && !aborted; ++move) {
+            board.placeStone(move->row, move->col, mover);
+            settle(board, *move);
+            board.removeStone(move->row, move->col);
+            if (proven(*move)) win = move;
+        }
+        if (win == moves.end()) return;
+        moves[0] = *win;
+        moves.truncate(1);
+    }
+    
+    for (const auto& move : moves) {
+        bool known = proven(move);
+        board.placeStone(move.row, move.col, mover);
+        if (!known) settle(board, move);
+        proof.push_back(ProofNode{move, {}});
+        if (depth > 1) buildProof(board, move, depth - 1, proof.back().replies);
+        board.removeStone(move.row, move.col);
+        if (aborted) return;
+    }
+}
+
+ProofSolver::Result ProofSolver::solve(const Board& position, const Limits& limits) {
+    auto startTime = std::chrono::steady_clock::now();
+    Board board = position;
+    attacker = board.sideToMove();
+    attacks = limits.attacks;
+    nodes = 0;
+    nodeLimit = limits.nodes;
+    deadline = limits.time.count() > 0 ? startTime + limits.time : std::chrono::steady_clock::time_point::max();
+    aborted = false;
+    
+    Result result;
+    Position none(-1, -1);
+    settle(board, none);
+    const Entry* root = probe(key(board.getHash(), true, none));
+    if (root && root->proof == 0) {
+        result.status = Result::Status::PROVEN;
+        // Extraction may have to search replaced subtrees again; limits
+        // no longer apply
+        aborted = false;
+        nodeLimit = 0;
+        deadline = std::chrono::steady_clock::time_point::max();
+        std::vector<ProofNode> proof;
+        buildProof(board, none, limits.proofTree ? BOARD_SIZE * BOARD_SIZE : 1, proof);
+        if (!proof.empty()) result.move = proof.front().move;
+        if (limits.proofTree) result.proof = std::move(proof);
+    } else if (root && root->disproof == 0) {
+        result.status = Result::Status::DISPROVEN;
+    }
+    result.nodes = nodes;
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    return result;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,141 @@
+// dfpn.h - Depth-first proof-number solver of libgomoku
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+namespace gomoku {
+
+// Answers whether the side to move wins by force, with depth-first
+// proof-number search (df-pn). The attacker, the side to move, needs one
+// winning move at each of its turns, and the defender must be refuted at
+// all of its replies. Proof and disproof numbers count the leaves still
+// to settle either way, and the search always grows the most promising
+// branch under thresholds, so it goes deep where the win is forced and
+// does not spend effort on lines a full-width search would.
+//
+// Attacks can be restricted to threats. Then the attacker only makes fours
+// (FOURS, a VCF search) or fours and open or split threes (THREATS, a VCT
+// search). The defender only answers with the cells of the threatened
+// lines or with counter-fours, the same move sets ThreatSolver uses. ALL
+// lifts the restriction to threats but still limits moves to an area:
+// the attacker plays the candidate cells within Board::NEAR_RANGE of a
+// stone, and the defender those and every cell that shares a five with a
+// stone. Neither a proof nor a disproof under ALL covers moves further
+// away, so neither settles the full game.
+//
+// Proof and disproof numbers live in a table of their own, whose size is
+// fixed at construction. When it fills, entries that took the least work to
+// settle are replaced, so memory stays bounded and long searches only lose
+// speed. The table is kept between calls and shared by every attacker and
+// move restriction.
+class ProofSolver {
+public:
+    enum class Attacks {
+        FOURS,    // VCF
+        THREATS,  // VCT
+        ALL       // every candidate move
+    };
+    
+    struct Limits {
+        Attacks attacks = Attacks::THREATS;
+        long long nodes = 0;                // node budget; zero: none
+        std::chrono::milliseconds time{0};  // wall-clock budget; zero: none
+        bool proofTree = true;              // return the proof of a win
+    };
+    
+    // One move of a proof: an attacker move answered by every defence in
+    // replies, or a defence answered by the one winning attacker move
+    struct ProofNode {
+        Position move;
+        std::vector<ProofNode> replies;
+    };
+    
+    struct Result {
+        enum class Status {
+            PROVEN,     // the side to move wins
+            DISPROVEN,  // it has no win with the allowed attacks
+            UNKNOWN     // a limit was reached first
+        };
+        
+        Status status = Status::UNKNOWN;
+        Position move;                  // first winning move when proven
+        long long nodes = 0;            // positions searched, tree extraction included
+        std::chrono::milliseconds elapsed{0};
+        std::vector<ProofNode> proof;   // the winning move and its tree, when asked for
+    };
+    
+    explicit ProofSolver(size_t tableMegabytes = 64);
+    
+    // Not safe while a search is running; forgets earlier results
+    void setTableSize(size_t megabytes);
+    
+    // Forgets everything learnt from earlier searches
+    void clear();
+    
+    Result solve(const Board& position, const Limits& limits);
+    Result solve(const Board& position) { return solve(position, Limits()); }
+    
+private:
+    static constexpr uint32_t INFINITE = 0x3FFFFFFF;
+    static constexpr int BUCKET_SIZE = 4;
+    
+    struct Entry {
+        uint64_t key = 0;
+        uint32_t proof = 1;
+        uint32_t disproof = 1;
+        uint32_t work = 0;  // nodes spent on it, for replacement
+    };
+    
+    struct Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+    
+    std::vector<Bucket> table;
+    size_t tableMask;
+    
+    // Current search
+    Stone attacker;
+    Attacks attacks;
+    long long nodes;
+    long long nodeLimit;
+    std::chrono::steady_clock::time_point deadline;
+    bool aborted;
+    
+    static Stone other(Stone stone) { return stone == Stone::BLACK ? Stone::WHITE : Stone::BLACK; }
+    
+    static uint32_t add(uint32_t a, uint32_t b) {
+        if (a >= INFINITE || b >= INFINITE) return INFINITE;
+        return std::min(a + b, INFINITE - 1);
+    }
+    
+    // Key of the position on board after move (which may be invalid for
+    // none) by the side not to move; defender nodes depend on the move
+    // under threat restriction, since it decides the defences
+    uint64_t key(uint64_t stonesHash, bool attackerToMove, Position move) const;
+    
+    const Entry* probe(uint64_t key) const;
+    void store(uint64_t key, uint32_t proof, uint32_t disproof, uint32_t work);
+    
+    // Candidate moves of the side to move. Returns false and sets the
+    // numbers when the position is settled without a move: a five to
+    // complete, two fives to stop, or no allowed move.
+    bool generate(const Board& board, Position last, MoveList& moves, uint32_t& proof, uint32_t& disproof) const;
+    
+    void mid(Board& board, Position last, uint32_t proofThreshold, uint32_t disproofThreshold);
+    
+    // Searches the position after last until it is settled or a limit hits
+    void settle(Board& board, Position last);
+    
+    // Proof of the proven position after last, depth plies deep
+    void buildProof(Board& board, Position last, int depth, std::vector<ProofNode>& proof);
+    
+    bool outOfTime();
+};
+
+}  // namespace gomoku
@@ -0,0 +1,769 @@
+// engine.cpp - Iterative-deepening alpha-beta search of libgomoku
+#include "engine.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <utility>
+
+#include "stats.h"
+#include "threat_solver.h"
+#include "transposition_table.h"
+#include "opening_book.h"
+
+namespace gomoku {
+
+// Iterative-deepening alpha-beta with Lazy SMP behind Engine
+class Searcher {
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    // Side to move at the root of the current search
+    Stone myStone;
+    Stone opponentStone;
+    std::mt19937 rng;
+    TranspositionTable tt;
+    const OpeningBook* book;  // not owned; may be shared by many engines
+    ThreatSolver solver;
+    
+    // Shared by all search threads
+    Clock::time_point deadline;
+    std::atomic<bool> stop;
+    SearchLimits limits;
+    
+    struct MoveScore {
+        Position move;
+        int score;
+        int tieBreak;  // orders moves of equal score
+        MoveScore(Position m = Position(), int s = 0, int t = 0) : move(m), score(s), tieBreak(t) {}
+    };
+    
+    struct IterationResult {
+        Position move;
+        int score = -INFINITY_SCORE;
+        int depth = 0;
+        std::vector<Position> pv;
+    };
+    
+    // Search state owned by one thread. Workers run the same iterative
+    // deepening loop on their own board copy and share only the transposition
+    // table and the stop flag (Lazy SMP); helpers differ from the main worker
+    // by starting one ply deeper and by their root move order. Each worker
+    // owns its per-ply move lists, so the search makes no allocations.
+    class Worker {
+    public:
+        long long nodes;
+        long long ttProbes;
+        long long ttHits;
+        std::vector<SearchResult::Iteration> iterations;  // main worker only
+        StatCounters stats;
+        
+        Worker(Searcher& owner, const Board& position, int workerId, uint32_t seed)
+            : nodes(0), ttProbes(0), ttHits(0), ai(owner), board(position), id(workerId), rng(seed),
+              pvLength{}, followPV(false), history{} {
+            for (auto& slots : killers) {
+                slots.fill(Position(-1, -1));
+            }
+        }
+        
+        IterationResult iterate(const MoveList& rootMoves, int depthLimit,
+                                Clock::time_point startTime) {
+            MoveList& moves = moveStack[0];
+            moves = rootMoves;
+            IterationResult best;
+            best.move = moves[0];
+            previousPV.clear();
+            
+            if (id > 0 && moves.size() > 2) {
+                std::shuffle(moves.begin() + 1, moves.end(), rng);
+            }
+            
+            for (int depth = 1 + (id & 1); depth <= depthLimit; depth++) {
+                if (!previousPV.empty()) {
+                    promoteMove(board, moves, previousPV[0].row * BOARD_SIZE + previousPV[0].col);
+                }
+                
+                IterationResult iteration;
+                iteration.move = moves[0];
+                iteration.depth = depth;
+                
+                for (const auto& move : moves) {
+                    followPV = !previousPV.empty() && move == previousPV[0];
+                    board.placeStone(move.row, move.col, ai.myStone);
+                    // Moves within the random margin of the best are searched exactly
+                    int score = minimax(1, depth - 1, iteration.score - 10, INFINITY_SCORE, false, true);
+                    board.removeStone(move.row, move.col);
+                    if (ai.stop.load(std::memory_order_relaxed)) break;
+                    
+                    // Add small random factor for variety
+                    score += (rng() % 10) - 5;
+                    
+                    if (score > iteration.score) {
+                        iteration.score = score;
+                        iteration.move = move;
+                        iteration.pv.assign(1, move);
+                        iteration.pv.insert(iteration.pv.end(), pvTable[1].begin() + 1,
+                                            pvTable[1].begin() + std::max(pvLength[1], 1));
+                    }
+                }
+                if (ai.stop.load(std::memory_order_relaxed)) break;
+                
+                best = iteration;
+                previousPV = iteration.pv;
+                if (id == 0) {
+                    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime);
+                    iterations.push_back({depth, iteration.score, nodes, elapsed});
+                }
+                
+                // A forced result will not change with more depth
+                if (std::abs(best.score) > WIN_THRESHOLD) break;
+                
+                // The next iteration would not finish in the remaining time
+                if (ai.deadline != Clock::time_point::max() &&
+                    Clock::now() - startTime > (ai.deadline - startTime) / 2) {
+                    break;
+                }
+            }
+            return best;
+        }
+        
+    private:
+        Searcher& ai;
+        Board board;
+        int id;
+        std::mt19937 rng;
+        
+        // Triangular principal variation table; the PV of the last completed
+        // iteration is searched first while following it
+        std::array<std::array<Position, MAX_PLY>, MAX_PLY> pvTable;
+        std::array<int, MAX_PLY> pvLength;
+        std::vector<Position> previousPV;
+        bool followPV;
+        
+        // Move list of each ply (the root's at 0) and scratch space for orderMoves
+        std::array<MoveList, MAX_PLY> moveStack;
+        std::array<MoveScore, MoveList::CAPACITY> scoreBuffer;
+        
+        // Two killer moves per ply, and cutoff history per colour and cell
+        std::array<std::array<Position, 2>, MAX_PLY> killers;
+        std::array<std::array<int, BOARD_SIZE * BOARD_SIZE>, 2> history;
+        
+        // ply counts moves from the root and draft the plies still to search;
+        // reductions make the two differ. nullAllowed is false right after a
+        // null move, so two passes never follow each other.
+        int minimax(int ply, int draft, int alpha, int beta, bool isMaximizing, bool nullAllowed) {
+            pvLength[ply] = ply;
+            
+            // Poll the clock every 64 nodes; an aborted iteration is discarded
+            if ((++nodes & 63) == 0 && Clock::now() >= ai.deadline) {
+                ai.stop.store(true, std::memory_order_relaxed);
+            }
+            if (ai.stop.load(std::memory_order_relaxed)) return 0;
+            
+            Stone myStone = ai.myStone;
+            GameStatus status = board.checkWin();
+            
+            // Terminal node evaluation
+            if (status != GameStatus::ONGOING) {
+                if (status == GameStatus::DRAW) return 0;
+                bool iWon = (status == GameStatus::BLACK_WIN && myStone == Stone::BLACK) ||
+                           (status == GameStatus::WHITE_WIN && myStone == Stone::WHITE);
+                return iWon ? WIN_SCORE - ply : -WIN_SCORE + ply;
+            }
+            
+            // A four must be answered at once: only the answers are searched,
+            // and they cost no depth
+            Stone toMove = isMaximizing ? myStone : ai.opponentStone;
+            Stone waiting = isMaximizing ? ai.opponentStone : myStone;
+            LinePatterns::Threat lastThreat = lastMoveThreat(waiting);
+            bool forced = ai.limits.threatExtensions && lastThreat >= LinePatterns::FOUR;
+            if (forced && ply + draft < MAX_PLY - 1) {
+                draft++;
+            }
+            
+            if (draft <= 0) {
+                if (ai.limits.quiescence) return quiesce(ply, 0, alpha, beta, isMaximizing);
+                PhaseTimer timer(stats, SearchStats::EVALUATION);
+                stats.countLeaf();
+                return staticScore();
+            }
+            
+            // Transposition table lookup
+            uint64_t key = positionKey(board, toMove);
+            int hashMove = TranspositionTable::NO_MOVE;
+            TranspositionTable::Entry entry;
+            ttProbes++;
+            if (ai.tt.probe(key, entry)) {
+                ttHits++;
+                hashMove = entry.move;
+                if (entry.depth >= draft) {
+                    int ttScore = scoreFromTT(entry.score, ply);
+                    if (entry.bound == TranspositionTable::Bound::EXACT) return ttScore;
+                    if (entry.bound == TranspositionTable::Bound::LOWER) alpha = std::max(alpha, ttScore);
+                    if (entry.bound == TranspositionTable::Bound::UPPER) beta = std::min(beta, ttScore);
+                    if (beta <= alpha) return ttScore;
+                }
+            }
+            int alphaOrig = alpha;
+            int betaOrig = beta;
+            
+            // Selective search applies to null-window nodes only, so the
+            // principal variation is always searched full width, and only
+            // when the opponent's last move made less than a split three
+            bool nullWindow = beta - alpha == 1;
+            bool selective = nullWindow && lastThreat < LinePatterns::SPLIT_THREE;
+            int staticEval = selective ? staticScore() : 0;
+            
+            // Null move: let the opponent move twice. If a shallower search
+            // still fails high the real moves would too. Passing never helps
+            // in gomoku, so the only risk is an opponent's threat that the
+            // reduced depth hides. The selective guard above skips positions
+            // where the last move made a three or a four; older threats are
+            // left to the reduced search.
+            if (selective && ai.limits.nullMove && nullAllowed && draft >= NULL_MOVE_MIN_DRAFT &&
+                (isMaximizing ? staticEval >= beta : staticEval <= alpha)) {
+                int reduction = draft > NULL_MOVE_DEEP_DRAFT ? NULL_MOVE_REDUCTION + 1 : NULL_MOVE_REDUCTION;
+                followPV = false;
+                int eval = minimax(ply + 1, draft - 1 - reduction, alpha, beta, !isMaximizing, false);
+                if (ai.stop.load(std::memory_order_relaxed)) return 0;
+                // Proven wins are not trusted from a position that cannot occur
+                if (isMaximizing && eval >= beta) return std::min(eval, WIN_THRESHOLD);
+                if (!isMaximizing && eval <= alpha) return std::max(eval, -WIN_THRESHOLD);
+            }
+            
+            // Futility: one ply from the leaves, a quiet move changes the
+            // static score by less than FUTILITY_MARGIN, so when even that
+            // cannot reach the window the quiet moves are not searched
+            bool futile = selective && ai.limits.futility && draft == 1 &&
+                          (isMaximizing ? staticEval + FUTILITY_MARGIN <= alpha : staticEval - FUTILITY_MARGIN >= beta);
+            
+            MoveList& moves = moveStack[ply];
+            {
+                PhaseTimer timer(stats, SearchStats::MOVE_GENERATION);
+                stats.countMoveGeneration();
+                board.getRelevantMoves(moves);
+                if (forced) keepFiveCells(moves, toMove, waiting);
+            }
+            if (moves.empty()) return 0;
+            
+            // Move ordering for better pruning: PV move, then hash move, then
+            // threats, killers and history
+            orderMoves(moves, toMove, ply);
+            promoteMove(board, moves, hashMove);
+            bool onPV = followPV && ply < static_cast<int>(previousPV.size());
+            if (onPV) {
+                const Position& pvMove = previousPV[ply];
+                promoteMove(board, moves, pvMove.row * BOARD_SIZE + pvMove.col);
+            }
+            
+            // Principal variation search: the first move gets the full window,
+            // the rest a null window that only proves them worse, and a move
+            // that is not gets searched again with the full window. Late quiet
+            // moves get their null-window search reduced first and are
+            // searched to full draft only if the reduced search does not
+            // prove them worse.
+            int bestEval = isMaximizing ? -INFINITY_SCORE : INFINITY_SCORE;
+            Position bestMove = moves[0];
+            bool cutoff = false;
+            for (int i = 0; i < moves.size(); i++) {
+                const Position& move = moves[i];
+                bool pvMove = onPV && move == previousPV[ply];
+                bool quiet = i > 0 && !pvMove && !isTactical(move, toMove) &&
+                             !(move == killers[ply][0] || move == killers[ply][1]);
+                if (futile && quiet) {
+                    // The skipped move may still reach the margin, so the
+                    // bound stored for this node must allow for it
+                    bestEval = isMaximizing ? std::max(bestEval, staticEval + FUTILITY_MARGIN)
+                                            : std::min(bestEval, staticEval - FUTILITY_MARGIN);
+                    continue;
+                }
+                int reduction = 0;
+                if (quiet && ai.limits.lateMoveReductions && draft >= LMR_MIN_DRAFT && i >= LMR_FIRST_MOVE) {
+                    reduction = std::min(i >= LMR_LATE_MOVE ? 2 : 1, draft - 2);
+                }
+                
+                followPV = pvMove;
+                board.placeStone(move.row, move.col, toMove);
+                int eval;
+                if (i == 0) {
+                    eval = minimax(ply + 1, draft - 1, alpha, beta, !isMaximizing, true);
+                } else {
+                    // Null window on the side of the bound this node improves
+                    int low = isMaximizing ? alpha : beta - 1;
+                    int high = low + 1;
+                    eval = minimax(ply + 1, draft - 1 - reduction, low, high, !isMaximizing, true);
+                    if (reduction > 0 && (isMaximizing ? eval > alpha : eval < beta)) {
+                        followPV = false;
+                        eval = minimax(ply + 1, draft - 1, low, high, !isMaximizing, true);
+                    }
+                    if (eval > alpha && eval < beta) {
+                        followPV = pvMove;
+                        eval = minimax(ply + 1, draft - 1, alpha, beta, !isMaximizing, true);
+                    }
+                }
+                board.removeStone(move.row, move.col);
+                if (ai.stop.load(std::memory_order_relaxed)) return 0;
+                
+                if (isMaximizing ? eval > bestEval : eval < bestEval) {
+                    bestEval = eval;
+                    bestMove = move;
+                }
+                if (isMaximizing ? eval > alpha : eval < beta) {
+                    (isMaximizing ? alpha : beta) = eval;
+                    updatePV(ply, move);
+                }
+                if (beta <= alpha) {
+                    cutoff = true;
+                    stats.countCutoff(i);
+                    break;
+                }
+            }
+            
+            if (cutoff) {
+                rewardCutoff(bestMove, toMove, ply, draft);
+            }
+            
+            TranspositionTable::Bound bound = TranspositionTable::Bound::EXACT;
+            if (bestEval <= alphaOrig) bound = TranspositionTable::Bound::UPPER;
+            else if (bestEval >= betaOrig) bound = TranspositionTable::Bound::LOWER;
+            ai.tt.store(key, draft, bound, scoreToTT(bestEval, ply),
+                        bestMove.row * BOARD_SIZE + bestMove.col);
+            
+            return bestEval;
+        }
+        
+        // Static evaluation for the root side, kept below the range reserved
+        // for proven wins
+        int staticScore() const {
+            return std::clamp(PatternEvaluator::evaluatePosition(board, ai.myStone), -WIN_THRESHOLD + 1,
+                              WIN_THRESHOLD - 1);
+        }
+        
+        // Strongest shape the last move made along its lines, if stone made
+        // it. Selective search is off after a three or a four, and a four
+        // extends the search.
+        LinePatterns::Threat lastMoveThreat(Stone stone) const {
+            const auto& moves = board.getMoveHistory();
+            if (moves.empty()) return LinePatterns::NONE;
+            const Position& last = moves.back();
+            if (board.getStone(last.row, last.col) != stone) return LinePatterns::NONE;
+            return ThreatSolver::bestThreat(board, last.row, last.col, stone);
+        }
+        
+        // Quiescence search past the nominal depth: only fours, and with
+        // limits.quiescenceThrees open and split threes in the first
+        // QUIESCENCE_THREE_PLIES plies, until the position is quiet. The
+        // side to move may stand pat on the static score unless it faces a
+        // four, which it has to block. qply counts the plies since the leaf.
+        int quiesce(int ply, int qply, int alpha, int beta, bool isMaximizing) {
+            pvLength[ply] = ply;
+            if ((++nodes & 63) == 0 && Clock::now() >= ai.deadline) {
+                ai.stop.store(true, std::memory_order_relaxed);
+            }
+            if (ai.stop.load(std::memory_order_relaxed)) return 0;
+            
+            Stone myStone = ai.myStone;
+            GameStatus status = board.checkWin();
+            if (status != GameStatus::ONGOING) {
+                if (status == GameStatus::DRAW) return 0;
+                bool iWon = (status == GameStatus::BLACK_WIN && myStone == Stone::BLACK) ||
+                           (status == GameStatus::WHITE_WIN && myStone == Stone::WHITE);
+                return iWon ? WIN_SCORE - ply : -WIN_SCORE + ply;
+            }
+            if (ply >= MAX_PLY - 1) return staticScore();
+            
+            Stone toMove = isMaximizing ? myStone : ai.opponentStone;
+            Stone waiting = isMaximizing ? ai.opponentStone : myStone;
+            int win = isMaximizing ? WIN_SCORE - (ply + 1) : -WIN_SCORE + (ply + 1);
+            int loss = isMaximizing ? -WIN_SCORE + (ply + 2) : WIN_SCORE - (ply + 2);
+            
+            // Fives decide at once; otherwise keep the side's fours, and its
+            // threes while they are allowed, in front of the other candidates
+            MoveList& moves = moveStack[ply];
+            {
+                PhaseTimer timer(stats, SearchStats::MOVE_GENERATION);
+                stats.countMoveGeneration();
+                board.getRelevantMoves(moves);
+            }
+            LinePatterns::Threat minimum = LinePatterns::FIVE;
+            if (qply < QUIESCENCE_PLIES) minimum = LinePatterns::FOUR;
+            if (ai.limits.quiescenceThrees && qply < QUIESCENCE_THREE_PLIES) minimum = LinePatterns::SPLIT_THREE;
+            int blocks = 0;
+            Position block;
+            int fours = 0;
+            int count = 0;
+            for (const auto& move : moves) {
+                if (board.makesFive(move.row, move.col, toMove)) return win;
+                if (board.makesFive(move.row, move.col, waiting)) {
+                    blocks++;
+                    block = move;
+                }
+                LinePatterns::Threat threat = ThreatSolver::bestThreat(board, move.row, move.col, toMove);
+                if (threat >= minimum) {
+                    moves[count++] = move;
+                    if (threat >= LinePatterns::FOUR) std::swap(moves[count - 1], moves[fours++]);
+                }
+            }
+            moves.truncate(count);
+            if (blocks > 1) return loss;
+            
+            int bestEval;
+            if (blocks == 1) {
+                // A four must be blocked; the block is the only move
+                moves.clear();
+                moves.push_back(block);
+                bestEval = isMaximizing ? -INFINITY_SCORE : INFINITY_SCORE;
+            } else {
+                PhaseTimer timer(stats, SearchStats::EVALUATION);
+                stats.countLeaf();
+                bestEval = staticScore();
+                if (isMaximizing ? bestEval >= beta : bestEval <= alpha) return bestEval;
+                if (isMaximizing) alpha = std::max(alpha, bestEval);
+                else beta = std::min(beta, bestEval);
+            }
+            
+            for (const auto& move : moves) {
+                board.placeStone(move.row, move.col, toMove);
+                int eval = quiesce(ply + 1, qply + 1, alpha, beta, !isMaximizing);
+                board.removeStone(move.row, move.col);
+                if (ai.stop.load(std::memory_order_relaxed)) return 0;
+                
+                if (isMaximizing ? eval > bestEval : eval < bestEval) bestEval = eval;
+                if (isMaximizing ? eval > alpha : eval < beta) {
+                    (isMaximizing ? alpha : beta) = eval;
+                    updatePV(ply, move);
+                }
+                if (beta <= alpha) break;
+            }
+            return bestEval;
+        }
+        
+        // Keeps the moves that complete a five for either side, if any
+        void keepFiveCells(MoveList& moves, Stone toMove, Stone waiting) const {
+            int count = 0;
+            for (const auto& move : moves) {
+                if (board.makesFive(move.row, move.col, toMove) || board.makesFive(move.row, move.col, waiting)) {
+                    moves[count++] = move;
+                }
+            }
+            if (count > 0) moves.truncate(count);
+        }
+        
+        // Moves that make or block a four or a three are never pruned or
+        // reduced
+        bool isTactical(const Position& move, Stone stone) const {
+            Stone opponent = (stone == Stone::BLACK) ? Stone::WHITE : Stone::BLACK;
+            return PatternEvaluator::isThreat(board, move, stone) || PatternEvaluator::isThreat(board, move, opponent);
+        }
+        
+        // Ordering keys: static threat score, with killers lifted above quiet
+        // moves, then history. No move is made, so this costs a few table
+        // lookups per candidate.
+        void orderMoves(MoveList& moves, Stone stone, int ply) {
+            PhaseTimer timer(stats, SearchStats::MOVE_ORDERING);
+            const auto& colorHistory = history[stone == Stone::BLACK ? 0 : 1];
+            int count = 0;
+            for (const auto& move : moves) {
+                int score = threatOrder(board, move, stone);
+                if (move == killers[ply][0] || move == killers[ply][1]) {
+                    score += KILLER_BONUS;
+                }
+                scoreBuffer[count++] = MoveScore(move, score, colorHistory[move.row * BOARD_SIZE + move.col]);
+            }
+            sortAndTrim(moves, scoreBuffer.data(), count);
+        }
+        
+        // The move that caused a cutoff becomes a killer at this ply and
+        // gains history in proportion to the depth it was searched to
+        void rewardCutoff(const Position& move, Stone stone, int ply, int draft) {
+            if (!(move == killers[ply][0])) {
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = move;
+            }
+            int& score = history[stone == Stone::BLACK ? 0 : 1][move.row * BOARD_SIZE + move.col];
+            score += draft * draft;
+            if (score > HISTORY_LIMIT) {
+                for (auto& colorHistory : history) {
+                    for (int& value : colorHistory) value /= 2;
+                }
+            }
+        }
+        
+        void updatePV(int ply, const Position& move) {
+            pvTable[ply][ply] = move;
+            for (int i = ply + 1; i < pvLength[ply + 1]; i++) {
+                pvTable[ply][i] = pvTable[ply + 1][i];
+            }
+            pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+        }
+    };
+    
+    // Win/loss scores are stored relative to the node so that they stay
+    // correct when the same position is reached at a different ply
+    static int scoreToTT(int score, int ply) {
+        if (score > WIN_THRESHOLD) return score + ply;
+        if (score < -WIN_THRESHOLD) return score - ply;
+        return score;
+    }
+    
+    static int scoreFromTT(int score, int ply) {
+        if (score > WIN_THRESHOLD) return score - ply;
+        if (score < -WIN_THRESHOLD) return score + ply;
+        return score;
+    }
+    
+    static uint64_t positionKey(const Board& board, Stone toMove) {
+        return board.getHash() ^ (toMove == Stone::WHITE ? Zobrist::sideToMove() : 0);
+    }
+    
+    // Search the hash move first, even if ordering would have cut it
+    static void promoteMove(const Board& board, MoveList& moves, int cell) {
+        if (cell == TranspositionTable::NO_MOVE) return;
+        Position first(cell / BOARD_SIZE, cell % BOARD_SIZE);
+        Position* it = std::find(moves.begin(), moves.end(), first);
+        if (it != moves.end()) {
+            std::rotate(moves.begin(), it, it + 1);
+        } else if (board.isValidMove(first.row, first.col)) {
+            moves.push_front(first);
+        }
+    }
+    
+    // Ordering weight of the shape a stone at a cell would make along one
+    // line, indexed by LinePatterns::Threat
+    static constexpr std::array<int, 10> THREAT_ORDER = {0, 1, 2, 8, 8, 40, 50, 1000, 5000, 100000};
+    // Lifts killers above every move that neither makes nor stops a four
+    static constexpr int KILLER_BONUS = THREAT_ORDER[LinePatterns::FOUR] - 1;
+    // History scores are halved once one of them passes this
+    static constexpr int HISTORY_LIMIT = 1 << 20;
+    
+    // Selective search. Null moves are tried from this draft on and
+    // searched this much shallower, one ply more past NULL_MOVE_DEEP_DRAFT.
+    static constexpr int NULL_MOVE_MIN_DRAFT = 3;
+    static constexpr int NULL_MOVE_REDUCTION = 2;
+    static constexpr int NULL_MOVE_DEEP_DRAFT = 6;
+    // Quiet moves from the LMR_FIRST_MOVE-th on are reduced by one ply, and
+    // from the LMR_LATE_MOVE-th on by two, at drafts from LMR_MIN_DRAFT
+    static constexpr int LMR_MIN_DRAFT = 3;
+    static constexpr int LMR_FIRST_MOVE = 3;
+    static constexpr int LMR_LATE_MOVE = 6;
+    // Above the largest change of the static score by a quiet move seen in
+    // random positions (about 900)
+    static constexpr int FUTILITY_MARGIN = PatternScore::OPEN_THREE;
+    // Quiescence search tries fours, and threes when asked, this many
+    // plies past the leaves; blocks of fours are searched at any ply
+    static constexpr int QUIESCENCE_PLIES = 4;
+    static constexpr int QUIESCENCE_THREE_PLIES = 2;
+    
+    // Cheap static ordering score of playing stone at move: the shapes it
+    // makes for stone, counted double, plus the shapes it takes from the
+    // opponent
+    static int threatOrder(const Board& board, const Position& move, Stone stone) {
+        Stone opponent = (stone == Stone::BLACK) ? Stone::WHITE : Stone::BLACK;
+        int attack = 0;
+        int defence = 0;
+        for (int dir = 0; dir < 4; dir++) {
+            attack += THREAT_ORDER[board.getThreat(move.row, move.col, stone, dir)];
+            defence += THREAT_ORDER[board.getThreat(move.row, move.col, opponent, dir)];
+        }
+        return 2 * attack + defence;
+    }
+    
+    // Sorts scored moves best first and keeps the top 10 in moves
+    static void sortAndTrim(MoveList& moves, MoveScore* scoredMoves, int count) {
+        std::sort(scoredMoves, scoredMoves + count,
+                 [](const MoveScore& a, const MoveScore& b) {
+                     return a.score != b.score ? a.score > b.score : a.tieBreak > b.tieBreak;
+                 });
+        
+        moves.clear();
+        for (int i = 0; i < count; i++) {
+            moves.push_back(scoredMoves[i].move);
+            if (moves.size() >= 10) break; // Limit branching factor
+        }
+    }
+    
+    // Root ordering: keeps the 10 best moves by a one-ply look; scoredMoves
+    // needs room for every move in the list
+    static void orderMoves(Board& board, MoveList& moves, Stone stone, MoveScore* scoredMoves) {
+        int count = 0;
+        
+        for (const auto& move : moves) {
+            int score = 0;
+            
+            // Check for immediate win
+            if (board.makesFive(move.row, move.col, stone)) {
+                score = INFINITY_SCORE;
+            } else {
+                board.placeStone(move.row, move.col, stone);
+                
+                // Quick evaluation
+                score = PatternEvaluator::evaluatePosition(board, stone);
+                
+                // Check if it blocks opponent's threat
+                Stone opponent = (stone == Stone::BLACK) ? Stone::WHITE : Stone::BLACK;
+                if (PatternEvaluator::isThreat(board, move, opponent)) {
+                    score += 5000;
+                }
+                board.removeStone(move.row, move.col);
+            }
+            
+            scoredMoves[count++] = MoveScore(move, score);
+        }
+        
+        sortAndTrim(moves, scoredMoves, count);
+    }
+    
+public:
+    explicit Searcher(size_t hashMegabytes)
+        : myStone(Stone::BLACK),
+          opponentStone(Stone::WHITE),
+          rng(std::chrono::steady_clock::now().time_since_epoch().count()),
+          tt(hashMegabytes),
+          book(nullptr),
+          stop(false) {}
+    
+    void setHashSize(size_t megabytes) { tt.resize(megabytes); }
+    
+    void setSeed(uint32_t seed) { rng.seed(seed); }
+    
+    void setOpeningBook(const OpeningBook* openingBook) { book = openingBook; }
+    
+    void clear() {
+        tt.clear();
+        solver.clear();
+    }
+    
+    SearchResult search(const Board& position, const SearchLimits& limits) {
+        auto startTime = Clock::now();
+        Board board = position;
+        myStone = board.sideToMove();
+        opponentStone = (myStone == Stone::BLACK) ? Stone::WHITE : Stone::BLACK;
+        tt.newSearch();
+        deadline = limits.time.count() > 0 ? startTime + limits.time : Clock::time_point::max();
+        stop.store(false);
+        this->limits = limits;
+        
+        // Ticks at the start calibrate the phase timers of this search
+        uint64_t startTicks = StatCounters::ticks();
+        StatCounters rootStats;
+        
+        SearchResult result;
+        auto finish = [&](SearchResult::Source source, const Position& move) {
+            result.source = source;
+            result.move = move;
+            result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime);
+            rootStats.addTo(result.stats, startTicks, Clock::now() - startTime);
+            return result;
+        };
+        
+        int bookMove;
+        if (book && book->probe(board.getHash(), bookMove, static_cast<uint32_t>(rng())) && bookMove < BOARD_SIZE * BOARD_SIZE &&
+            board.isValidMove(bookMove / BOARD_SIZE, bookMove % BOARD_SIZE)) {
+            return finish(SearchResult::Source::BOOK, Position(bookMove / BOARD_SIZE, bookMove % BOARD_SIZE));
+        }
+        
+        MoveList moves;
+        board.getRelevantMoves(moves);
+        if (moves.empty()) {
+            return finish(SearchResult::Source::IMMEDIATE, Position(BOARD_SIZE / 2, BOARD_SIZE / 2));
+        }
+        
+        // Check for immediate win or block
+        for (const auto& move : moves) {
+            // Check for win
+            if (board.makesFive(move.row, move.col, myStone)) {
+                return finish(SearchResult::Source::IMMEDIATE, move);
+            }
+        }
+        for (const auto& move : moves) {
+            // Check for blocking opponent's win
+            if (board.makesFive(move.row, move.col, opponentStone)) {
+                return finish(SearchResult::Source::IMMEDIATE, move);
+            }
+        }
+        
+        // A forced win by continuous threats needs no full-width search. The
+        // solver may use a quarter of the time, so the search still gets the
+        // rest.
+        Position forcedMove;
+        bool forced;
+        {
+            PhaseTimer timer(rootStats, SearchStats::THREAT_SOLVER);
+            Clock::time_point solverDeadline =
+                limits.time.count() > 0 ? startTime + limits.time / 4 : Clock::time_point::max();
+            forced = solver.solveVCF(board, myStone, forcedMove, ThreatSolver::VCF_DEPTH, solverDeadline) ||
+                     solver.solveVCT(board, myStone, forcedMove, ThreatSolver::VCT_DEPTH, solverDeadline);
+        }
+        if (forced) {
+            result.nodes = solver.getNodes();
+            return finish(SearchResult::Source::FORCED_WIN, forcedMove);
+        }
+        
+        std::array<MoveScore, MoveList::CAPACITY> scoredMoves;
+        orderMoves(board, moves, myStone, scoredMoves.data());
+        
+        // Use minimax for best move: the main worker plus helpers on the shared table
+        int threadCount = std::max(1, limits.threads);
+        int depthLimit = std::clamp(limits.depth, 1, MAX_PLY - 1);
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (int i = 0; i < threadCount; i++) {
+            workers.push_back(std::make_unique<Worker>(*this, board, i, static_cast<uint32_t>(rng())));
+        }
+        
+        std::vector<IterationResult> results(threadCount);
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threadCount; i++) {
+            helpers.emplace_back([&, i] {
+                results[i] = workers[i]->iterate(moves, depthLimit, startTime);
+            });
+        }
+        results[0] = workers[0]->iterate(moves, depthLimit, startTime);
+        stop.store(true);
+        for (auto& helper : helpers) {
+            helper.join();
+        }
+        
+        // Prefer the deepest completed iteration; the main worker wins ties
+        const IterationResult* best = &results[0];
+        for (const auto& iteration : results) {
+            if (iteration.depth > best->depth) best = &iteration;
+        }
+        for (const auto& worker : workers) {
+            result.nodes += worker->nodes;
+            result.ttProbes += worker->ttProbes;
+            result.ttHits += worker->ttHits;
+            worker->stats.addTo(result.stats, startTicks, Clock::now() - startTime);
+        }
+        result.score = best->score;
+        result.depth = best->depth;
+        result.threads = threadCount;
+        result.pv = best->pv;
+        result.iterations = std::move(workers[0]->iterations);
+        return finish(SearchResult::Source::SEARCH, best->move);
+    }
+};
+
+Engine::Engine(size_t hashMegabytes) : searcher(std::make_unique<Searcher>(hashMegabytes)) {}
+
+Engine::~Engine() = default;
+
+Engine::Engine(Engine&&) noexcept = default;
+
+Engine& Engine::operator=(Engine&&) noexcept = default;
+
+void Engine::setHashSize(size_t megabytes) { searcher->setHashSize(megabytes); }
+
+void Engine::setSeed(uint32_t seed) { searcher->setSeed(seed); }
+
+void Engine::setOpeningBook(const OpeningBook* book) { searcher->setOpeningBook(book); }
+
+void Engine::clear() { searcher->clear(); }
+
+SearchResult Engine::search(const Board& position, const SearchLimits& limits) {
+    return searcher->search(position, limits);
+}
+
+}  // namespace gomoku
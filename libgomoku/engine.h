@@ -0,0 +1,124 @@
+// engine.h - Search API of libgomoku
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "board.h"
+
+class OpeningBook;
+
+namespace gomoku {
+
+class Searcher;
+
+struct SearchLimits {
+    int depth = MAX_DEPTH;               // iterative deepening stops after this many plies
+    std::chrono::milliseconds time{0};   // wall-clock budget; zero: none
+    int threads = 1;                     // search threads, including the caller's
+    long long playouts = 0;              // MctsEngine playout budget; zero: none
+
+    // Selective search of Engine, each switchable on its own so its effect
+    // can be measured. All three stay off the principal variation and out
+    // of positions where the last move made a four or a three.
+    bool lateMoveReductions = true;  // search late quiet moves shallower first
+    bool nullMove = true;            // prune when passing still fails high
+    bool futility = true;            // skip quiet moves that cannot reach alpha one ply from the leaves
+
+    // Against the horizon effect, also switchable for measurement
+    bool threatExtensions = true;   // a reply to a four does not count towards the depth
+    bool quiescence = true;         // play out fours past the leaves before evaluating
+    bool quiescenceThrees = false;  // quiescence also tries threes for two plies
+};
+
+// Search profile, filled in only by a libgomoku built with GOMOKU_STATS
+// (the CMake option of that name); all zero otherwise. Thread counts and
+// times are summed over the search threads, so with helpers the phase
+// times add up to more than the wall-clock time.
+struct SearchStats {
+    enum Phase {
+        MOVE_GENERATION,  // candidate moves of interior nodes
+        MOVE_ORDERING,    // threat, killer and history ordering
+        EVALUATION,       // static evaluation of leaves
+        THREAT_SOLVER,    // VCF/VCT check before the search
+        PHASE_COUNT
+    };
+
+    // Cutoffs counted by the index of the move that caused them; the last
+    // slot also counts every later move
+    static constexpr int CUTOFF_SLOTS = 8;
+
+    bool enabled = false;
+    long long leafEvaluations = 0;
+    long long moveGenerations = 0;
+    std::array<long long, CUTOFF_SLOTS> cutoffsByMove{};
+    std::array<std::chrono::microseconds, PHASE_COUNT> phaseTime{};
+};
+
+struct SearchResult {
+    enum class Source {
+        SEARCH,      // alpha-beta or Monte Carlo tree search
+        IMMEDIATE,   // completes or blocks five
+        BOOK,        // opening book
+        FORCED_WIN   // VCF/VCT solver
+    };
+
+    // One completed iteration of the main search thread
+    struct Iteration {
+        int depth;
+        int score;
+        long long nodes;                    // main thread only, since the search began
+        std::chrono::microseconds elapsed;  // since the search began
+    };
+
+    Position move;
+    Source source = Source::SEARCH;
+    int score = 0;           // for the side to move; search results only. MCTS: win rate scaled to -1000..1000
+    int depth = 0;           // deepest completed iteration; MCTS: deepest tree path
+    long long nodes = 0;     // alpha-beta nodes, MCTS playouts, or solver nodes for forced wins
+    long long ttProbes = 0;  // transposition table lookups, all threads
+    long long ttHits = 0;    // lookups that found the position
+    int threads = 1;
+    std::chrono::milliseconds elapsed{0};
+    std::vector<Position> pv;  // principal variation, root move first
+    std::vector<Iteration> iterations;
+    SearchStats stats;
+};
+
+// An engine keeps its transposition table, solver cache and random state
+// between searches, so consecutive moves of one game search faster on the
+// same engine. Engines are independent: one per thread or per game. The
+// side to move is taken from the position (black when the stone count is
+// even).
+class Engine {
+public:
+    explicit Engine(size_t hashMegabytes = 16);
+    ~Engine();
+
+    Engine(Engine&&) noexcept;
+    Engine& operator=(Engine&&) noexcept;
+
+    // Not safe while a search is running
+    void setHashSize(size_t megabytes);
+
+    // Seeds the move-choice noise, so a game can be replayed
+    void setSeed(uint32_t seed);
+
+    // Book consulted before every search; not owned, may be shared by many
+    // engines; nullptr disables it
+    void setOpeningBook(const OpeningBook* book);
+
+    // Forgets everything learnt from earlier searches
+    void clear();
+
+    SearchResult search(const Board& position, const SearchLimits& limits = SearchLimits());
+
+private:
+    std::unique_ptr<Searcher> searcher;
+};
+
+}  // namespace gomoku
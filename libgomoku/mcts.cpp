@@ -0,0 +1,564 @@
+// mcts.cpp - Monte Carlo tree search engine of libgomoku
+#include "mcts.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "batch_playout.h"
+#include "board_scorer.h"
+#include "padded_board.h"
+#include "patterns.h"
+
+namespace gomoku {
+
+// The position a playout runs on: a PaddedBoard plus, for every cell and
+// both colours, the sum of the line-shape scores of a stone there, kept up
+// to date move by move. A move only changes the keys of the cells within
+// LinePatterns::REACH of it along its four lines, so play() adjusts those
+// 64 scores instead of rescoring the board. Copying one is a few kilobytes
+// of flat arrays, which is how each playout gets its own.
+class RolloutBoard {
+public:
+    // Line score of five in a row; no other shape in the four directions
+    // adds up to it
+    static constexpr int FIVE = 100000;
+    // Policy scores of a move that completes five and of one that stops the
+    // opponent's, above every other score
+    static constexpr int WIN_MOVE = 1000000;
+    static constexpr int BLOCK_MOVE = 999999;
+    static constexpr int NEAR_RANGE = Board::NEAR_RANGE;
+    
+    // One policy score per candidate cell
+    struct Candidate {
+        int cell;
+        int score;
+    };
+    
+    using Candidates = std::array<Candidate, BOARD_SIZE * BOARD_SIZE>;
+    
+    explicit RolloutBoard(const Board& position) : side(PaddedBoard::BLACK), empty(BOARD_SIZE * BOARD_SIZE), near{} {
+        for (const auto& move : position.getMoveHistory()) {
+            int stone = position.getStone(move.row, move.col) == Stone::BLACK ? PaddedBoard::BLACK : PaddedBoard::WHITE;
+            board.set(move.row, move.col, stone);
+            addNear(PaddedBoard::index(move.row, move.col));
+            empty--;
+        }
+        side = position.sideToMove() == Stone::BLACK ? PaddedBoard::BLACK : PaddedBoard::WHITE;
+        BoardScorer::scoreAll(board, LINE_SCORES.data(), scores[0], scores[1]);
+    }
+    
+    int sideToMove() const { return side; }
+    
+    static int cellOf(int row, int col) { return PaddedBoard::index(row, col); }
+    
+    static Position positionOf(int cell) {
+        return Position(cell / PaddedBoard::STRIDE - PaddedBoard::PAD, cell % PaddedBoard::STRIDE - PaddedBoard::PAD);
+    }
+    
+    // Greedy score of the side to move playing cell, as gmk-ai-ai-v3's
+    // hardest setting weighs it: attack plus nine tenths of defence, each
+    // with the centre bonus, and completing or stopping five above all
+    int policyScore(int cell) const {
+        int attack = scores[side - 1][cell];
+        int defence = scores[2 - side][cell];
+        if (attack >= FIVE) return WIN_MOVE;
+        if (defence >= FIVE) return BLOCK_MOVE;
+        return attack + defence * 9 / 10 + CENTER_BONUS[cell] * 19 / 10;
+    }
+    
+    // True if the side to move completes five at cell
+    bool makesFive(int cell) const { return scores[side - 1][cell] >= FIVE; }
+    
+    // Empty cells within NEAR_RANGE of a stone, with their policy scores;
+    // the centre alone on an empty board
+    int candidates(Candidates& out) const {
+        if (empty == BOARD_SIZE * BOARD_SIZE) {
+            int center = cellOf(BOARD_SIZE / 2, BOARD_SIZE / 2);
+            out[0] = {center, policyScore(center)};
+            return 1;
+        }
+        int count = 0;
+        for (int cell = FIRST; cell < LAST; cell++) {
+            if (near[cell] && board[cell] == PaddedBoard::EMPTY) out[count++] = {cell, policyScore(cell)};
+        }
+        return count;
+    }
+    
+    void play(int cell) {
+        board.set(cell / PaddedBoard::STRIDE - PaddedBoard::PAD, cell % PaddedBoard::STRIDE - PaddedBoard::PAD, side);
+        const uint8_t* cells = board.data();
+        for (int step : PaddedBoard::DIRECTIONS) {
+            for (int n = 0; n < LinePatterns::NEIGHBOURS; n++) {
+                int neighbour = cell + LinePatterns::offset(n) * step;
+                if (cells[neighbour] == PaddedBoard::BORDER) continue;
+                // The played cell is neighbour NEIGHBOURS - 1 - n of this
+                // one and was EMPTY (code 0) in the old key
+                int blackKey = board.lineKey(neighbour, step, PaddedBoard::BLACK);
+                int oldBlackKey = blackKey & ~(3 << (2 * (LinePatterns::NEIGHBOURS - 1 - n)));
+                scores[0][neighbour] += LINE_SCORES[blackKey] - LINE_SCORES[oldBlackKey];
+                scores[1][neighbour] += LINE_SCORES[swapColours(blackKey)] - LINE_SCORES[swapColours(oldBlackKey)];
+            }
+        }
+        addNear(cell);
+        empty--;
+        side = 3 - side;
+    }
+    
+    bool isFull() const { return empty == 0; }
+    
+    const PaddedBoard& cells() const { return board; }
+    
+private:
+    static constexpr int FIRST = PaddedBoard::index(0, 0);
+    static constexpr int LAST = PaddedBoard::index(BOARD_SIZE - 1, BOARD_SIZE - 1) + 1;
+    
+    // gmk-ai-ai-v3's line score: run length and open ends of the stone's
+    // shape, with no credit for broken shapes
+    static int scoreLine(const LinePatterns::Window& window) {
+        int count = LinePatterns::run(window);
+        int openEnds = (LinePatterns::pastRun(window, 1) == LinePatterns::EMPTY) +
+                       (LinePatterns::pastRun(window, -1) == LinePatterns::EMPTY);
+        if (count >= 5) return FIVE;
+        if (count == 4) return openEnds == 2 ? 10000 : openEnds == 1 ? 5000 : 0;
+        if (count == 3) return openEnds == 2 ? 1000 : openEnds == 1 ? 500 : 0;
+        if (count == 2) return openEnds == 2 ? 100 : openEnds == 1 ? 50 : 0;
+        return 0;
+    }
+    
+    // Key of the same cells seen by the other colour: OWN and OPPONENT
+    // trade places, EMPTY and EDGE stay
+    static int swapColours(int key) { return ((key & 0x5555) << 1) | ((key >> 1) & 0x5555); }
+    
+    static std::array<int, PaddedBoard::CELLS> buildCenterBonus() {
+        std::array<int, PaddedBoard::CELLS> bonus{};
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            for (int col = 0; col < BOARD_SIZE; col++) {
+                bonus[cellOf(row, col)] = BOARD_SIZE - (std::abs(row - BOARD_SIZE / 2) + std::abs(col - BOARD_SIZE / 2));
+            }
+        }
+        return bonus;
+    }
+    
+    void addNear(int cell) {
+        for (int dRow = -NEAR_RANGE; dRow <= NEAR_RANGE; dRow++) {
+            for (int dCol = -NEAR_RANGE; dCol <= NEAR_RANGE; dCol++) {
+                near[cell + PaddedBoard::step(dRow, dCol)] = 1;
+            }
+        }
+    }
+    
+    static const std::array<int, LinePatterns::KEY_COUNT> LINE_SCORES;
+    static const std::array<int, PaddedBoard::CELLS> CENTER_BONUS;
+    
+    PaddedBoard board;
+    BoardScorer::Scores scores[2];  // black's and white's line scores of every cell
+    int side;
+    int empty;
+    std::array<uint8_t, PaddedBoard::CELLS> near;  // within NEAR_RANGE of a stone
+};
+
+const std::array<int, LinePatterns::KEY_COUNT> RolloutBoard::LINE_SCORES =
+    LinePatterns::build<int>(RolloutBoard::scoreLine);
+const std::array<int, PaddedBoard::CELLS> RolloutBoard::CENTER_BONUS = RolloutBoard::buildCenterBonus();
+
+static_assert(RolloutBoard::NEAR_RANGE <= PaddedBoard::PAD, "candidate marks must stay inside the padded board");
+
+// Tree, playouts and threads behind MctsEngine
+class TreeSearcher {
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr double EXPLORATION = 1.5;  // PUCT constant
+    static constexpr int MAX_CHILDREN = 24;     // best candidates by policy score
+    static constexpr int EXPAND_VISITS = 2;     // a leaf grows children on its second visit
+    static constexpr int ROLLOUT_PLIES = 60;    // a playout this long counts as a draw
+    static constexpr int MAX_TREE_DEPTH = BOARD_SIZE * BOARD_SIZE;
+    static constexpr uint32_t NO_NODE = ~0u;
+    
+    enum State : uint8_t {
+        LEAF,       // no children yet
+        EXPANDING,  // a thread is adding the children
+        EXPANDED,
+        WON,        // the move into the node completed five
+        DRAWN       // the board is full
+    };
+    
+    // Statistics are from the point of view of the player who made the
+    // move into the node; results are counted in half points, 2 per win
+    // and 1 per draw. visits counts the games of playouts still running,
+    // which is the virtual loss.
+    struct Node {
+        std::atomic<int32_t> visits;
+        std::atomic<int32_t> points;
+        std::atomic<uint8_t> state;
+        uint8_t move;         // row * BOARD_SIZE + col
+        uint16_t childCount;  // written before state becomes EXPANDED
+        uint32_t firstChild;
+        float prior;
+        
+        void reset(int cell, float p, State s) {
+            visits.store(0, std::memory_order_relaxed);
+            points.store(0, std::memory_order_relaxed);
+            state.store(s, std::memory_order_relaxed);
+            move = static_cast<uint8_t>(cell);
+            childCount = 0;
+            firstChild = NO_NODE;
+            prior = p;
+        }
+    };
+    
+    std::unique_ptr<Node[]> nodes;
+    uint32_t capacity;
+    std::mt19937 rng;
+    
+    // Shared by all search threads
+    std::atomic<uint32_t> used;
+    std::atomic<bool> poolFull;
+    std::atomic<long long> playouts;
+    std::atomic<bool> stop;
+    long long playoutLimit;
+    Clock::time_point deadline;
+    int rootSide;
+    MctsEngine::PlayoutPolicy policy;
+    int games;  // games per playout: one, or a batch's lanes
+    
+    // Search state owned by one thread
+    struct Worker {
+        std::mt19937 rng;
+        int maxDepth = 0;
+        uint32_t path[MAX_TREE_DEPTH + 1];
+        RolloutBoard::Candidates candidates;
+        BatchPlayout batch;
+        
+        explicit Worker(uint32_t seed) : rng(seed) {}
+    };
+    
+    static int toCell(int move) { return RolloutBoard::cellOf(move / BOARD_SIZE, move % BOARD_SIZE); }
+    
+    static int toMove(int cell) {
+        Position pos = RolloutBoard::positionOf(cell);
+        return pos.row * BOARD_SIZE + pos.col;
+    }
+    
+    // First of count consecutive nodes, or NO_NODE once the pool is spent
+    uint32_t allocate(int count) {
+        uint32_t first = used.fetch_add(static_cast<uint32_t>(count), std::memory_order_relaxed);
+        if (first + static_cast<uint64_t>(count) > capacity) {
+            poolFull.store(true, std::memory_order_relaxed);
+            return NO_NODE;
+        }
+        return first;
+    }
+    
+    // Adds the children of node, the position on board, unless another
+    // thread is already at it or the pool is spent. A move that completes
+    // five becomes the only child; when the opponent threatens five only
+    // the blocks are kept; otherwise the best MAX_CHILDREN candidates, with
+    // priors in proportion to their policy scores.
+    bool expand(Node& node, const RolloutBoard& board, Worker& worker) {
+        if (poolFull.load(std::memory_order_relaxed)) return false;
+        uint8_t expected = LEAF;
+        if (!node.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acquire)) return false;
+        
+        auto& candidates = worker.candidates;
+        int count = board.candidates(candidates);
+        if (count == 0) {
+            node.state.store(DRAWN, std::memory_order_release);
+            return true;
+        }
+        std::sort(candidates.begin(), candidates.begin() + count,
+                  [](const auto& a, const auto& b) { return a.score > b.score; });
+        if (candidates[0].score == RolloutBoard::WIN_MOVE) {
+            count = 1;
+        } else if (candidates[0].score == RolloutBoard::BLOCK_MOVE) {
+            count = static_cast<int>(std::find_if(candidates.begin(), candidates.begin() + count,
+                                                  [](const auto& c) { return c.score != RolloutBoard::BLOCK_MOVE; }) -
+                                     candidates.begin());
+        }
+        count = std::min(count, MAX_CHILDREN);
+        
+        uint32_t first = allocate(count);
+        if (first == NO_NODE) {
+            node.state.store(LEAF, std::memory_order_relaxed);
+            return false;
+        }
+        double total = 0;
+        for (int i = 0; i < count; i++) total += candidates[i].score;
+        for (int i = 0; i < count; i++) {
+            int cell = candidates[i].cell;
+            float prior = total > 0 ? static_cast<float>(candidates[i].score / total) : 1.0f / count;
+            nodes[first + i].reset(toMove(cell), prior, board.makesFive(cell) ? WON : LEAF);
+        }
+        node.firstChild = first;
+        node.childCount = static_cast<uint16_t>(count);
+        node.state.store(EXPANDED, std::memory_order_release);
+        return true;
+    }
+    
+    // PUCT: mean result plus an exploration term that favours high priors
+    // and few visits, counted in playouts. Unvisited children count as
+    // even.
+    uint32_t select(const Node& node) const {
+        double parentVisits = std::sqrt(std::max(1.0, node.visits.load(std::memory_order_relaxed) / double(games)));
+        uint32_t best = node.firstChild;
+        double bestValue = -1.0;
+        for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; i++) {
+            const Node& child = nodes[i];
+            int visits = child.visits.load(std::memory_order_relaxed);
+            int points = child.points.load(std::memory_order_relaxed);
+            double mean = visits > 0 ? points / (2.0 * visits) : 0.5;
+            double value = mean + EXPLORATION * child.prior * parentVisits / (1 + visits / double(games));
+            if (value > bestValue) {
+                bestValue = value;
+                best = i;
+            }
+        }
+        return best;
+    }
+    
+    // Plays the greedy policy from board to the end of the game: the best
+    // move seven times in ten, otherwise one of the best three at random,
+    // but always a move that completes or stops five. Returns the winner,
+    // or EMPTY for a draw.
+    int rollout(RolloutBoard& board, Worker& worker) const {
+        auto& candidates = worker.candidates;
+        for (int ply = 0; ply < ROLLOUT_PLIES; ply++) {
+            int count = board.candidates(candidates);
+            if (count == 0) return PaddedBoard::EMPTY;
+            
+            RolloutBoard::Candidate top[3] = {{-1, -1}, {-1, -1}, {-1, -1}};
+            for (int i = 0; i < count; i++) {
+                const auto& candidate = candidates[i];
+                if (candidate.score <= top[2].score) continue;
+                if (candidate.score > top[0].score) {
+                    top[2] = top[1];
+                    top[1] = top[0];
+                    top[0] = candidate;
+                } else if (candidate.score > top[1].score) {
+                    top[2] = top[1];
+                    top[1] = candidate;
+                } else {
+                    top[2] = candidate;
+                }
+            }
+            int choice = 0;
+            if (top[0].score < RolloutBoard::BLOCK_MOVE && worker.rng() % 10 >= 7) {
+                choice = static_cast<int>(worker.rng() % std::min(count, 3));
+            }
+            
+            int mover = board.sideToMove();
+            bool wins = board.makesFive(top[choice].cell);
+            board.play(top[choice].cell);
+            if (wins) return mover;
+        }
+        return PaddedBoard::EMPTY;
+    }
+    
+    // One playout: descend by PUCT counting the visits, grow the leaf, play
+    // out from it and add the result along the path. A batch playout plays
+    // its games from the same leaf and counts each of them.
+    void playout(const RolloutBoard& root, Worker& worker) {
+        RolloutBoard board = root;
+        uint32_t* path = worker.path;
+        int length = 0;
+        path[length++] = 0;
+        nodes[0].visits.fetch_add(games, std::memory_order_relaxed);
+        
+        // Games won by black and by white; the rest were drawn
+        int wins[2] = {0, 0};
+        for (;;) {
+            Node& node = nodes[path[length - 1]];
+            uint8_t state = node.state.load(std::memory_order_acquire);
+            if (state == WON) {
+                // The move into the node was made by the side not to move now
+                wins[2 - board.sideToMove()] = games;
+                break;
+            }
+            if (state == DRAWN) break;
+            if (state == EXPANDED) {
+                uint32_t child = select(node);
+                nodes[child].visits.fetch_add(games, std::memory_order_relaxed);
+                board.play(toCell(nodes[child].move));
+                path[length++] = child;
+                continue;
+            }
+            if ((length == 1 || node.visits.load(std::memory_order_relaxed) >= EXPAND_VISITS * games) &&
+                expand(node, board, worker)) {
+                continue;
+            }
+            if (policy == MctsEngine::PlayoutPolicy::BATCH) {
+                worker.batch.reset(board.cells(), board.sideToMove());
+                BatchPlayout::Results results = worker.batch.run((uint64_t(worker.rng()) << 32) | worker.rng(), ROLLOUT_PLIES);
+                wins[0] = Bitboard::popcount(results.blackWins);
+                wins[1] = Bitboard::popcount(results.whiteWins);
+            } else if (int winner = rollout(board, worker); winner != PaddedBoard::EMPTY) {
+                wins[winner - 1] = 1;
+            }
+            break;
+        }
+        worker.maxDepth = std::max(worker.maxDepth, length - 1);
+        
+        // The root's move was the opponent's; movers alternate from there
+        int mover = 3 - rootSide;
+        for (int i = 0; i < length; i++) {
+            int points = 2 * wins[mover - 1] + (games - wins[0] - wins[1]);
+            if (points) nodes[path[i]].points.fetch_add(points, std::memory_order_relaxed);
+            mover = 3 - mover;
+        }
+    }
+    
+    void run(const RolloutBoard& root, Worker& worker) {
+        for (long long n = 0; !stop.load(std::memory_order_relaxed); n++) {
+            if (playouts.fetch_add(games, std::memory_order_relaxed) >= playoutLimit ||
+                ((n & 15) == 15 && Clock::now() >= deadline)) {
+                stop.store(true, std::memory_order_relaxed);
+                break;
+            }
+            playout(root, worker);
+        }
+    }
+    
+    // Most visited child of node, or NO_NODE before any visit
+    uint32_t mostVisited(const Node& node) const {
+        if (node.state.load(std::memory_order_acquire) != EXPANDED) return NO_NODE;
+        uint32_t best = NO_NODE;
+        int bestVisits = 0;
+        for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; i++) {
+            int visits = nodes[i].visits.load(std::memory_order_relaxed);
+            if (visits > bestVisits) {
+                bestVisits = visits;
+                best = i;
+            }
+        }
+        return best;
+    }
+    
+public:
+    explicit TreeSearcher(size_t treeMegabytes)
+        : capacity(0),
+          rng(std::chrono::steady_clock::now().time_since_epoch().count()),
+          used(0),
+          poolFull(false),
+          playouts(0),
+          stop(false),
+          playoutLimit(0),
+          rootSide(PaddedBoard::BLACK),
+          policy(MctsEngine::PlayoutPolicy::GREEDY),
+          games(1) {
+        setTreeSize(treeMegabytes);
+    }
+    
+    void setTreeSize(size_t megabytes) {
+        size_t count = std::clamp<size_t>(megabytes * 1024 * 1024 / sizeof(Node), MAX_CHILDREN + 1, NO_NODE - 1);
+        nodes = std::make_unique<Node[]>(count);
+        capacity = static_cast<uint32_t>(count);
+    }
+    
+    void setSeed(uint32_t seed) { rng.seed(seed); }
+    
+    void setPlayoutPolicy(MctsEngine::PlayoutPolicy playoutPolicy) { policy = playoutPolicy; }
+    
+    SearchResult search(const Board& position, const SearchLimits& limits) {
+        auto startTime = Clock::now();
+        Stone myStone = position.sideToMove();
+        Stone opponentStone = (myStone == Stone::BLACK) ? Stone::WHITE : Stone::BLACK;
+        
+        SearchResult result;
+        auto finish = [&](SearchResult::Source source, const Position& move) {
+            result.source = source;
+            result.move = move;
+            result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime);
+            return result;
+        };
+        
+        MoveList moves;
+        position.getRelevantMoves(moves);
+        if (moves.empty()) {
+            return finish(SearchResult::Source::IMMEDIATE, Position(BOARD_SIZE / 2, BOARD_SIZE / 2));
+        }
+        for (const auto& move : moves) {
+            if (position.makesFive(move.row, move.col, myStone)) return finish(SearchResult::Source::IMMEDIATE, move);
+        }
+        for (const auto& move : moves) {
+            if (position.makesFive(move.row, move.col, opponentStone)) return finish(SearchResult::Source::IMMEDIATE, move);
+        }
+        
+        RolloutBoard root(position);
+        rootSide = root.sideToMove();
+        nodes[0].reset(0, 1.0f, LEAF);
+        used.store(1);
+        poolFull.store(false);
+        playouts.store(0);
+        stop.store(false);
+        games = policy == MctsEngine::PlayoutPolicy::BATCH ? BatchPlayout::LANES : 1;
+        bool timed = limits.time.count() > 0;
+        deadline = timed ? startTime + limits.time : Clock::time_point::max();
+        playoutLimit = limits.playouts > 0 ? limits.playouts : timed ? std::numeric_limits<long long>::max() : MctsEngine::DEFAULT_PLAYOUTS;
+        
+        int threadCount = std::max(1, limits.threads);
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (int i = 0; i < threadCount; i++) {
+            workers.push_back(std::make_unique<Worker>(static_cast<uint32_t>(rng())));
+        }
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threadCount; i++) {
+            helpers.emplace_back([&, i] { run(root, *workers[i]); });
+        }
+        run(root, *workers[0]);
+        stop.store(true);
+        for (auto& helper : helpers) {
+            helper.join();
+        }
+        
+        uint32_t best = mostVisited(nodes[0]);
+        if (best == NO_NODE) {
+            // Not one playout: too little time, fall back on the policy
+            RolloutBoard::Candidates candidates;
+            int count = root.candidates(candidates);
+            auto top = std::max_element(candidates.begin(), candidates.begin() + count,
+                                        [](const auto& a, const auto& b) { return a.score < b.score; });
+            return finish(SearchResult::Source::SEARCH, RolloutBoard::positionOf(top->cell));
+        }
+        
+        const Node& chosen = nodes[best];
+        int visits = chosen.visits.load();
+        result.score = static_cast<int>(std::lround((chosen.points.load() / (2.0 * visits) * 2.0 - 1.0) * 1000.0));
+        for (uint32_t node = best; node != NO_NODE; node = mostVisited(nodes[node])) {
+            result.pv.push_back(Position(nodes[node].move / BOARD_SIZE, nodes[node].move % BOARD_SIZE));
+        }
+        for (const auto& worker : workers) {
+            result.depth = std::max(result.depth, worker->maxDepth);
+        }
+        result.nodes = nodes[0].visits.load();
+        result.threads = threadCount;
+        return finish(SearchResult::Source::SEARCH, result.pv.front());
+    }
+};
+
+MctsEngine::MctsEngine(size_t treeMegabytes) : searcher(std::make_unique<TreeSearcher>(treeMegabytes)) {}
+
+MctsEngine::~MctsEngine() = default;
+
+MctsEngine::MctsEngine(MctsEngine&&) noexcept = default;
+
+MctsEngine& MctsEngine::operator=(MctsEngine&&) noexcept = default;
+
+void MctsEngine::setTreeSize(size_t megabytes) { searcher->setTreeSize(megabytes); }
+
+void MctsEngine::setSeed(uint32_t seed) { searcher->setSeed(seed); }
+
+void MctsEngine::setPlayoutPolicy(PlayoutPolicy policy) { searcher->setPlayoutPolicy(policy); }
+
+SearchResult MctsEngine::search(const Board& position, const SearchLimits& limits) {
+    return searcher->search(position, limits);
+}
+
+}  // namespace gomoku
@@ -0,0 +1,62 @@
+// mcts.h - Monte Carlo tree search engine of libgomoku
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "engine.h"
+
+namespace gomoku {
+
+class TreeSearcher;
+
+// Monte Carlo tree search, an alternative to the alpha-beta Engine with the
+// same search interface. Children are chosen by PUCT, with priors from the
+// greedy move scores of gmk-ai-ai-v3 (attack plus nine tenths of defence,
+// over the line shapes through the cell), and leaves are valued by
+// playing that greedy policy, slightly randomised, to the end of the game.
+//
+// Every thread of a search descends the one shared tree (tree
+// parallelism). Node statistics are atomics, and a thread counts its visit
+// on the way down, so a playout still running reads as a loss to the
+// others (virtual loss) and steers them to other lines. Nodes come from a
+// pool allocated up front; when it runs out the tree stops growing and the
+// search carries on with playouts from its leaves.
+//
+// SearchLimits::depth is not used: a search runs for limits.time or
+// limits.playouts games, whichever ends first, or DEFAULT_PLAYOUTS games
+// when neither is set. The tree is rebuilt for every search.
+class MctsEngine {
+public:
+    static constexpr long long DEFAULT_PLAYOUTS = 20000;
+
+    enum class PlayoutPolicy {
+        GREEDY,  // one game per playout with the greedy policy above
+        BATCH    // 64 bit-sliced games per playout that only make, block
+                 // or play next to a stone (BatchPlayout)
+    };
+
+    explicit MctsEngine(size_t treeMegabytes = 64);
+    ~MctsEngine();
+
+    MctsEngine(MctsEngine&&) noexcept;
+    MctsEngine& operator=(MctsEngine&&) noexcept;
+
+    // Not safe while a search is running
+    void setTreeSize(size_t megabytes);
+
+    // Seeds the playout randomness; one thread with a playout limit then
+    // searches the same way every time
+    void setSeed(uint32_t seed);
+
+    // GREEDY unless set; not safe while a search is running
+    void setPlayoutPolicy(PlayoutPolicy policy);
+
+    SearchResult search(const Board& position, const SearchLimits& limits = SearchLimits());
+
+private:
+    std::unique_ptr<TreeSearcher> searcher;
+};
+
+}  // namespace gomoku
@@ -0,0 +1,105 @@
+// stats.h - Search instrumentation of libgomoku, compiled in with GOMOKU_STATS
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "engine.h"
+
+#if defined(GOMOKU_STATS) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define GOMOKU_STATS_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace gomoku {
+
+#ifdef GOMOKU_STATS
+inline constexpr bool STATS_ENABLED = true;
+#else
+inline constexpr bool STATS_ENABLED = false;
+#endif
+
+// Counters of one search thread behind SearchStats. Every method is empty
+// unless STATS_ENABLED, so the hot paths pay nothing in normal builds.
+// Phase times are kept in raw ticks: the time-stamp counter on x86, where
+// reading it costs a few cycles, and steady_clock nanoseconds elsewhere.
+class StatCounters {
+public:
+    static uint64_t ticks() {
+#if defined(GOMOKU_STATS_RDTSC)
+        return __rdtsc();
+#else
+        if constexpr (!STATS_ENABLED) return 0;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    void countLeaf() {
+        if constexpr (STATS_ENABLED) leafEvaluations++;
+    }
+
+    void countMoveGeneration() {
+        if constexpr (STATS_ENABLED) moveGenerations++;
+    }
+
+    void countCutoff(int moveIndex) {
+        if constexpr (STATS_ENABLED) {
+            cutoffsByMove[moveIndex < SearchStats::CUTOFF_SLOTS ? moveIndex : SearchStats::CUTOFF_SLOTS - 1]++;
+        }
+    }
+
+    void addTicks(SearchStats::Phase phase, uint64_t elapsed) {
+        if constexpr (STATS_ENABLED) phaseTicks[phase] += elapsed;
+    }
+
+    // Adds these counts to stats; ticks are converted with the tick rate
+    // measured over the whole search, startTicks to now
+    void addTo(SearchStats& stats, uint64_t startTicks, std::chrono::steady_clock::duration searchTime) const {
+        if constexpr (STATS_ENABLED) {
+            stats.enabled = true;
+            stats.leafEvaluations += leafEvaluations;
+            stats.moveGenerations += moveGenerations;
+            for (int i = 0; i < SearchStats::CUTOFF_SLOTS; i++) {
+                stats.cutoffsByMove[i] += cutoffsByMove[i];
+            }
+            double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(searchTime).count());
+            uint64_t searchTicks = ticks() - startTicks;
+            double microsecondsPerTick = searchTicks > 0 ? nanoseconds / 1000.0 / static_cast<double>(searchTicks) : 0.0;
+            for (int i = 0; i < SearchStats::PHASE_COUNT; i++) {
+                stats.phaseTime[i] += std::chrono::microseconds(static_cast<long long>(phaseTicks[i] * microsecondsPerTick));
+            }
+        }
+    }
+
+private:
+    long long leafEvaluations = 0;
+    long long moveGenerations = 0;
+    long long cutoffsByMove[SearchStats::CUTOFF_SLOTS] = {};
+    uint64_t phaseTicks[SearchStats::PHASE_COUNT] = {};
+};
+
+// Charges the ticks from construction to destruction to one phase
+class PhaseTimer {
+public:
+    PhaseTimer(StatCounters& counters, SearchStats::Phase phase)
+        : counters(counters), phase(phase), start(StatCounters::ticks()) {}
+
+    ~PhaseTimer() {
+        if constexpr (STATS_ENABLED) counters.addTicks(phase, StatCounters::ticks() - start);
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    StatCounters& counters;
+    SearchStats::Phase phase;
+    uint64_t start;
+};
+
+}  // namespace gomoku
@@ -0,0 +1,183 @@
+// threat_solver.cpp - VCF/VCT threat-space solver of libgomoku
+#include "threat_solver.h"
+
+namespace gomoku {
+
+Bitboard ThreatSolver::near(const Board& board, Stone stone, int range) {
+    Bitboard area = board.getStones(stone);
+    for (int i = 0; i < range; i++) area = area.dilate();
+    return area & ~board.occupied();
+}
+
+LinePatterns::Threat ThreatSolver::bestThreat(const Board& board, int row, int col, Stone stone) {
+    LinePatterns::Threat best = LinePatterns::NONE;
+    for (int dir = 0; dir < 4; dir++) {
+        best = std::max(best, board.getThreat(row, col, stone, dir));
+    }
+    return best;
+}
+
+int ThreatSolver::fiveCells(const Board& board, Stone stone, const Bitboard& area, Position found[2]) {
+    int count = 0;
+    area.forEach([&](int r, int c) {
+        if (count < 2 && board.makesFive(r, c, stone)) found[count++] = Position(r, c);
+    });
+    return count;
+}
+
+int ThreatSolver::fiveCellsThrough(const Board& board, int row, int col, Stone stone, Position found[2]) {
+    int count = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        auto [dr, dc] = DIRECTIONS[dir];
+        for (int k = -4; k <= 4 && count < 2; k++) {
+            int r = row + k * dr;
+            int c = col + k * dc;
+            if (k == 0 || !board.isValidMove(r, c) || !board.makesFive(r, c, stone)) continue;
+            if (count == 1 && found[0] == Position(r, c)) continue;
+            found[count++] = Position(r, c);
+        }
+    }
+    return count;
+}
+
+bool ThreatSolver::solve(Board& board, Stone attacker, bool threes, int depth, Clock::time_point until,
+                         Position& move) {
+    nodes = 0;
+    aborted = false;
+    deadline = until;
+    return attack(board, attacker, threes, std::min(depth, VCF_DEPTH), move);
+}
+
+uint64_t ThreatSolver::cacheKey(const Board& board, Stone attacker, bool threes) const {
+    return board.getHash() ^ (attacker == Stone::WHITE ? Zobrist::sideToMove() : 0) ^
+           (threes ? 0x9E3779B97F4A7C15ULL : 0);
+}
+
+bool ThreatSolver::attack(Board& board, Stone attacker, bool threes, int depth, Position& move) {
+    Stone defender = other(attacker);
+    Position cells[2];
+    
+    Bitboard area = near(board, attacker, 2);
+    if (fiveCells(board, attacker, area, cells) > 0) {
+        move = cells[0];
+        return true;
+    }
+    if (depth <= 0) return false;
+    // Poll the clock every 64 nodes, as the alpha-beta search does
+    if (aborted || ++nodes > NODE_LIMIT || ((nodes & 63) == 0 && Clock::now() >= deadline)) {
+        aborted = true;
+        return false;
+    }
+    
+    uint64_t key = cacheKey(board, attacker, threes);
+    CacheEntry& entry = cache[key & cacheMask];
+    if (entry.key == key && (entry.win || entry.depth >= depth)) {
+        move = Position(entry.move / BOARD_SIZE, entry.move % BOARD_SIZE);
+        return entry.win;
+    }
+    
+    // A defender four must be blocked, and the block must keep the initiative
+    int defenderFives = fiveCells(board, defender, near(board, defender, 1), cells);
+    if (defenderFives > 1) return false;
+    
+    bool win = false;
+    if (defenderFives == 1) {
+        Position block = cells[0];
+        if (bestThreat(board, block.row, block.col, attacker) >= LinePatterns::FOUR) {
+            win = tryFour(board, attacker, threes, depth, block);
+        }
+        if (win) move = block;
+    } else {
+        // Fours first: they are forcing and cheap to refute
+        MoveList& fours = plies[depth].fours;
+        MoveList& threats = plies[depth].threats;
+        fours.clear();
+        threats.clear();
+        area.forEach([&](int r, int c) {
+            LinePatterns::Threat threat = bestThreat(board, r, c, attacker);
+            if (threat >= LinePatterns::FOUR) fours.push_back(Position(r, c));
+            else if (threes && threat >= LinePatterns::SPLIT_THREE) threats.push_back(Position(r, c));
+        });
+        for (const auto& candidate : fours) {
+            if (tryFour(board, attacker, threes, depth, candidate)) {
+                win = true;
+                move = candidate;
+                break;
+            }
+        }
+        for (int i = 0; !win && i < threats.size(); i++) {
+            if (tryThree(board, attacker, depth, threats[i])) {
+                win = true;
+                move = threats[i];
+            }
+        }
+    }
+    
+    if (win || !aborted) {
+        entry.key = key;
+        entry.depth = static_cast<int8_t>(depth);
+        entry.win = win;
+        entry.move = static_cast<uint8_t>(move.row * BOARD_SIZE + move.col);
+    }
+    return win;
+}
+
+bool ThreatSolver::tryFour(Board& board, Stone attacker, bool threes, int depth, Position four) {
+    Stone defender = other(attacker);
+    Position cells[2];
+    
+    board.placeStone(four.row, four.col, attacker);
+    int count = fiveCellsThrough(board, four.row, four.col, attacker, cells);
+    bool win = count >= 2;  // open four or double four
+    if (count == 1) {
+        Position reply;
+        board.placeStone(cells[0].row, cells[0].col, defender);
+        win = attack(board, attacker, threes, depth - 1, reply);
+        board.removeStone(cells[0].row, cells[0].col);
+    }
+    board.removeStone(four.row, four.col);
+    return win;
+}
+
+bool ThreatSolver::tryThree(Board& board, Stone attacker, int depth, Position three) {
+    Stone defender = other(attacker);
+    
+    board.placeStone(three.row, three.col, attacker);
+    
+    // Defences: every empty cell along the threatened lines, and any
+    // four the defender can make instead
+    MoveList& defences = plies[depth].defences;
+    defences.clear();
+    for (int dir = 0; dir < 4; dir++) {
+        if (board.getThreat(three.row, three.col, attacker, dir) < LinePatterns::SPLIT_THREE) continue;
+        auto [dr, dc] = DIRECTIONS[dir];
+        for (int k = -4; k <= 4; k++) {
+            int r = three.row + k * dr;
+            int c = three.col + k * dc;
+            if (board.isValidMove(r, c) &&
+                std::find(defences.begin(), defences.end(), Position(r, c)) == defences.end()) {
+                defences.push_back(Position(r, c));
+            }
+        }
+    }
+    near(board, defender, 2).forEach([&](int r, int c) {
+        if (bestThreat(board, r, c, defender) >= LinePatterns::FOUR &&
+            std::find(defences.begin(), defences.end(), Position(r, c)) == defences.end()) {
+            defences.push_back(Position(r, c));
+        }
+    });
+    
+    bool win = true;
+    for (const auto& defence : defences) {
+        Position reply;
+        board.placeStone(defence.row, defence.col, defender);
+        win = attack(board, attacker, true, depth - 1, reply);
+        board.removeStone(defence.row, defence.col);
+        if (!win) break;
+    }
+    
+    board.removeStone(three.row, three.col);
+    return win;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,100 @@
+// threat_solver.h - VCF/VCT threat-space solver of libgomoku
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+namespace gomoku {
+
+// Threat-space search for forced wins. Only moves that make a four (VCF)
+// or, for VCT, an open or split three are tried for the attacker, and the
+// defender only gets the replies that can stop them: the single five cell
+// after a four; the cells along the threatened lines or a counter-four
+// after a three. That keeps the tree narrow enough to read wins dozens of
+// plies deep. Results are kept in a proof cache of their own.
+class ThreatSolver {
+public:
+    static constexpr int VCF_DEPTH = 20;      // attacker moves
+    static constexpr int VCT_DEPTH = 5;
+    static constexpr long long NODE_LIMIT = 20000;  // per call; up to about half a second
+    
+    using Clock = std::chrono::steady_clock;
+    
+    explicit ThreatSolver(size_t cacheBits = 16)
+        : cache(size_t(1) << cacheBits), cacheMask((size_t(1) << cacheBits) - 1), nodes(0), aborted(false),
+          deadline(Clock::time_point::max()), plies(VCF_DEPTH + 1) {}
+    
+    // True if attacker, to move, wins by continuous fours; move is the first
+    // move of the win. Depths beyond VCF_DEPTH are capped. The search gives
+    // up, finding no win, after NODE_LIMIT nodes or at deadline. The board
+    // is restored before returning.
+    bool solveVCF(Board& board, Stone attacker, Position& move, int depth = VCF_DEPTH,
+                  Clock::time_point deadline = Clock::time_point::max()) {
+        return solve(board, attacker, false, depth, deadline, move);
+    }
+    
+    // As solveVCF, but open threes may be used as well as fours
+    bool solveVCT(Board& board, Stone attacker, Position& move, int depth = VCT_DEPTH,
+                  Clock::time_point deadline = Clock::time_point::max()) {
+        return solve(board, attacker, true, depth, deadline, move);
+    }
+    
+    long long getNodes() const { return nodes; }
+    
+    void clear() { std::fill(cache.begin(), cache.end(), CacheEntry()); }
+    
+    // Empty cells within range of a stone of stone's colour
+    static Bitboard near(const Board& board, Stone stone, int range);
+    
+    // Strongest threat a stone at (row, col) makes in any direction
+    static LinePatterns::Threat bestThreat(const Board& board, int row, int col, Stone stone);
+    
+    // Empty cells where stone makes five, at most two of them
+    static int fiveCells(const Board& board, Stone stone, const Bitboard& area, Position found[2]);
+    
+private:
+    // A win holds at any depth; a failure only up to the depth it was searched to
+    struct CacheEntry {
+        uint64_t key = 0;
+        int8_t depth = -1;
+        bool win = false;
+        uint8_t move = 0;
+    };
+    
+    // Candidate lists for each remaining depth, allocated once
+    struct PlyMoves {
+        MoveList fours;
+        MoveList threats;
+        MoveList defences;
+    };
+    
+    std::vector<CacheEntry> cache;
+    size_t cacheMask;
+    long long nodes;
+    bool aborted;
+    Clock::time_point deadline;
+    std::vector<PlyMoves> plies;
+    
+    static Stone other(Stone stone) { return stone == Stone::BLACK ? Stone::WHITE : Stone::BLACK; }
+    
+    // Five cells on the lines through (row, col), which must hold a stone
+    static int fiveCellsThrough(const Board& board, int row, int col, Stone stone, Position found[2]);
+    
+    bool solve(Board& board, Stone attacker, bool threes, int depth, Clock::time_point until, Position& move);
+    
+    uint64_t cacheKey(const Board& board, Stone attacker, bool threes) const;
+    
+    // Attacker to move: true if every defence loses
+    bool attack(Board& board, Stone attacker, bool threes, int depth, Position& move);
+    
+    bool tryFour(Board& board, Stone attacker, bool threes, int depth, Position four);
+    
+    bool tryThree(Board& board, Stone attacker, int depth, Position three);
+};
+
+}  // namespace gomoku
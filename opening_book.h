@@ -0,0 +1,184 @@
+// opening_book.h - Memory-mapped opening book shared by the Gomoku engines
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// File layout (little-endian): the 8-byte magic "GMKBOOK1", a 64-bit entry
+// count, then 16-byte entries sorted by key and, for equal keys, by
+// descending weight. Keys are the Zobrist hash of the stones only (see
+// zobrist.h); the side to move follows from the stone count. Moves are cell
+// indices, row * 15 + col.
+//
+// The file is mapped read-only and probed in place with a binary search,
+// so opening a book costs no heap and one book can serve any number of
+// engines and threads.
+class OpeningBook {
+public:
+    struct Entry {
+        uint64_t key;
+        uint16_t move;
+        uint16_t weight;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Entry) == 16, "book entries are 16 bytes on disk");
+
+    OpeningBook() : mapping(nullptr), mappedSize(0), entries(nullptr), count(0) {}
+
+    explicit OpeningBook(const std::string& path) : OpeningBook() { open(path); }
+
+    ~OpeningBook() { close(); }
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Maps the file; false if it cannot be read or is not a valid book
+    bool open(const std::string& path) {
+        close();
+        if (!map(path)) return false;  // map() guarantees room for the header
+
+        Header header;
+        std::memcpy(&header, mapping, sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.count != (mappedSize - sizeof(Header)) / sizeof(Entry) ||
+            (mappedSize - sizeof(Header)) % sizeof(Entry) != 0) {
+            close();
+            return false;
+        }
+        entries = reinterpret_cast<const Entry*>(static_cast<const char*>(mapping) + sizeof(Header));
+        count = static_cast<size_t>(header.count);
+        return true;
+    }
+
+    void close() {
+        if (mapping) unmap();
+        mapping = nullptr;
+        mappedSize = 0;
+        entries = nullptr;
+        count = 0;
+    }
+
+    bool isOpen() const { return mapping != nullptr; }
+
+    size_t size() const { return count; }
+
+    // Entries for key, best first; empty if the position is not in the book
+    std::pair<const Entry*, const Entry*> lookup(uint64_t key) const {
+        const Entry* end = entries + count;
+        const Entry* first = std::lower_bound(entries, end, key,
+                                              [](const Entry& e, uint64_t k) { return e.key < k; });
+        const Entry* last = first;
+        while (last != end && last->key == key) last++;
+        return {first, last};
+    }
+
+    // Highest-weight book move for key
+    bool probe(uint64_t key, int& move) const {
+        auto range = lookup(key);
+        if (range.first == range.second) return false;
+        move = range.first->move;
+        return true;
+    }
+
+    // Book move for key chosen at random in proportion to the weights, so
+    // seeded engines still vary their openings
+    bool probe(uint64_t key, int& move, uint32_t random) const {
+        auto range = lookup(key);
+        uint32_t total = 0;
+        for (const Entry* e = range.first; e != range.second; e++) total += e->weight;
+        if (total == 0) return false;
+        uint32_t pick = random % total;
+        const Entry* chosen = range.first;
+        while (pick >= chosen->weight) {
+            pick -= chosen->weight;
+            chosen++;
+        }
+        move = chosen->move;
+        return true;
+    }
+
+    // Sorts entries into book order and writes them to path
+    static bool write(const std::string& path, std::vector<Entry> bookEntries) {
+        std::sort(bookEntries.begin(), bookEntries.end(), [](const Entry& a, const Entry& b) {
+            return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+        });
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        Header header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.count = bookEntries.size();
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(bookEntries.data(), sizeof(Entry), bookEntries.size(), file) == bookEntries.size();
+        return std::fclose(file) == 0 && ok;
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint64_t count;
+    };
+
+    static constexpr char MAGIC[8] = {'G', 'M', 'K', 'B', 'O', 'O', 'K', '1'};
+
+#ifdef _WIN32
+    bool map(const std::string& path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        HANDLE view = nullptr;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= static_cast<LONGLONG>(sizeof(Header))) {
+            view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        CloseHandle(file);
+        if (!view) return false;
+        mapping = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(view);
+        mappedSize = static_cast<size_t>(fileSize.QuadPart);
+        return mapping != nullptr;
+    }
+
+    void unmap() { UnmapViewOfFile(mapping); }
+#else
+    bool map(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(Header))) {
+            view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+        mapping = view;
+        mappedSize = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    void unmap() { munmap(const_cast<void*>(mapping), mappedSize); }
+#endif
+
+    const void* mapping;
+    size_t mappedSize;
+    const Entry* entries;
+    size_t count;
+};
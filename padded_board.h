@@ -0,0 +1,92 @@
+// padded_board.h - Flat bordered board shared by the greedy Gomoku engines
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "patterns.h"
+
+// One byte per cell in a single array, surrounded by BORDER cells wide
+// enough for the longest walk the engines make (LinePatterns::REACH cells
+// from any board cell). A direction is a fixed index step, so line walks
+// need no bounds tests: a run stops at the border like at any other
+// non-matching cell, and a line key reads the border as EDGE. Rows share
+// their padding columns, so the whole board fits in seven cache lines.
+class PaddedBoard {
+public:
+    static constexpr int SIZE = 15;
+    static constexpr int PAD = LinePatterns::REACH;
+    static constexpr int STRIDE = SIZE + PAD;  // the padding between rows serves both sides
+    // Rounded up to whole cache lines, which also lets vector code read a
+    // few bytes past the last border cell
+    static constexpr int CELLS = (STRIDE * (SIZE + 2 * PAD) + PAD + 63) / 64 * 64;
+
+    enum Cell : uint8_t { EMPTY = 0, BLACK = 1, WHITE = 2, BORDER = 3 };
+
+    // Index steps of the four line directions: horizontal, vertical,
+    // diagonal and anti-diagonal
+    static constexpr std::array<int, 4> DIRECTIONS = {1, STRIDE, STRIDE + 1, STRIDE - 1};
+
+    PaddedBoard() { clear(); }
+
+    static constexpr int index(int row, int col) { return (row + PAD) * STRIDE + col + PAD; }
+
+    static constexpr int step(int dRow, int dCol) { return dRow * STRIDE + dCol; }
+
+    static bool onBoard(int row, int col) { return row >= 0 && row < SIZE && col >= 0 && col < SIZE; }
+
+    void clear() {
+        cells.fill(BORDER);
+        for (int row = 0; row < SIZE; row++) {
+            for (int col = 0; col < SIZE; col++) {
+                cells[index(row, col)] = EMPTY;
+            }
+        }
+    }
+
+    int at(int row, int col) const { return cells[index(row, col)]; }
+
+    int operator[](int i) const { return cells[i]; }
+
+    const uint8_t* data() const { return cells.data(); }
+
+    void set(int row, int col, int player) { cells[index(row, col)] = static_cast<uint8_t>(player); }
+
+    // Stones of player in an unbroken run from i along step, i excluded
+    int countRun(int i, int step, int player) const {
+        int count = 0;
+        for (i += step; cells[i] == player; i += step) count++;
+        return count;
+    }
+
+    // LinePatterns key of the cells around i along step, seen by player
+    int lineKey(int i, int step, int player) const {
+        const auto& codes = CELL_CODES[player == WHITE];
+        int key = 0;
+        for (int n = 0; n < LinePatterns::NEIGHBOURS; n++) {
+            key |= codes[cells[i + LinePatterns::offset(n) * step]] << (2 * n);
+        }
+        return key;
+    }
+
+    // Any stone within radius cells of (row, col) in each direction;
+    // radius is at most PAD
+    bool hasNeighbour(int row, int col, int radius) const {
+        for (int dRow = -radius; dRow <= radius; dRow++) {
+            const uint8_t* line = &cells[index(row + dRow, col)];
+            for (int dCol = -radius; dCol <= radius; dCol++) {
+                if (line[dCol] == BLACK || line[dCol] == WHITE) return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    // LinePatterns cell of each board cell, for black and for white
+    static constexpr uint8_t CELL_CODES[2][4] = {
+        {LinePatterns::EMPTY, LinePatterns::OWN, LinePatterns::OPPONENT, LinePatterns::EDGE},
+        {LinePatterns::EMPTY, LinePatterns::OPPONENT, LinePatterns::OWN, LinePatterns::EDGE},
+    };
+
+    alignas(64) std::array<uint8_t, CELLS> cells;
+};
@@ -0,0 +1,187 @@
+// patterns.h - Compile-time line-shape tables shared by the Gomoku evaluators
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// A cell's shape in one direction depends only on the four cells on either
+// side of it. Each neighbour is packed into two bits (EMPTY, OWN, OPPONENT or
+// EDGE for cells off the board), nearest-last on the backward side and
+// nearest-first on the forward side:
+//
+//     offset  -4 -3 -2 -1  [centre]  +1 +2 +3 +4
+//     bits     0  2  4  6             8 10 12 14
+//
+// so the 16-bit key indexes a table. build() turns an engine's own scoring
+// rule into such a table; threat() gives the standard threat class of an own
+// stone at the centre. 65536-entry tables are too big for compilers'
+// constant-evaluation limits, so they are filled once at program start;
+// five-cell window tables are small enough to be constexpr.
+class LinePatterns {
+public:
+    static constexpr int REACH = 4;
+    static constexpr int NEIGHBOURS = 2 * REACH;
+    static constexpr int KEY_COUNT = 1 << (2 * NEIGHBOURS);
+
+    // Five-cell windows, for evaluators that score every window of a line
+    static constexpr int SPAN = 5;
+    static constexpr int SPAN_KEY_COUNT = 1 << (2 * SPAN);
+
+    enum Cell : uint8_t { EMPTY = 0, OWN = 1, OPPONENT = 2, EDGE = 3 };
+
+    // Ordered by strength, so the strongest of several lines is their max
+    enum Threat : uint8_t {
+        NONE,           // no five can ever be made through this stone
+        ONE,
+        BLOCKED_TWO,    // one move from a blocked three
+        OPEN_TWO,       // one move from an open or split three
+        BLOCKED_THREE,  // one move from a four
+        SPLIT_THREE,    // one move from an open four, with a gap: X_XX
+        OPEN_THREE,     // one move from an open four: XXX
+        FOUR,           // one cell makes five
+        OPEN_FOUR,      // two cells make five
+        FIVE
+    };
+
+    // The centre cell (index REACH) is always OWN
+    using Window = std::array<Cell, NEIGHBOURS + 1>;
+
+    // Board offset of neighbour i
+    static constexpr int offset(int i) { return i < REACH ? i - REACH : i - REACH + 1; }
+
+    // Own stones in the unbroken run through the centre
+    static constexpr int run(const Window& w) {
+        int count = 1;
+        for (int i = REACH + 1; i <= NEIGHBOURS && w[i] == OWN; i++) count++;
+        for (int i = REACH - 1; i >= 0 && w[i] == OWN; i--) count++;
+        return count;
+    }
+
+    // Cell just past the run through the centre, forward (dir = 1) or
+    // backward (dir = -1); EDGE if the run fills the window
+    static constexpr Cell pastRun(const Window& w, int dir) {
+        int i = REACH + dir;
+        while (i >= 0 && i <= NEIGHBOURS && w[i] == OWN) i += dir;
+        return (i >= 0 && i <= NEIGHBOURS) ? w[i] : EDGE;
+    }
+
+    static constexpr Window window(int key) {
+        Window w{};
+        for (int i = 0; i < NEIGHBOURS; i++) {
+            w[i < REACH ? i : i + 1] = static_cast<Cell>((key >> (2 * i)) & 3);
+        }
+        w[REACH] = OWN;
+        return w;
+    }
+
+    // Key from 8-bit neighbour masks (bit i = neighbour i); a cell set in both
+    // masks reads as EDGE, so callers can mark off-board cells by setting both
+    static int keyFromMasks(unsigned own, unsigned other) {
+        return SPREAD[own & 0xFF] | (SPREAD[other & 0xFF] << 1);
+    }
+
+    static Threat threat(int key) { return THREATS[key]; }
+
+    // Table of score(window) for every neighbour key
+    template <typename T, typename F>
+    static std::array<T, KEY_COUNT> build(F score) {
+        std::array<T, KEY_COUNT> table{};
+        for (int key = 0; key < KEY_COUNT; key++) {
+            table[key] = score(window(key));
+        }
+        return table;
+    }
+
+    // Table of score(cells) for every five-cell window; cell i of the window
+    // sits in bits 2i..2i+1, so sliding along a line is key = (key >> 2) | next << 8
+    template <typename T, typename F>
+    static constexpr std::array<T, SPAN_KEY_COUNT> buildSpans(F score) {
+        std::array<T, SPAN_KEY_COUNT> table{};
+        for (int key = 0; key < SPAN_KEY_COUNT; key++) {
+            std::array<Cell, SPAN> cells{};
+            for (int i = 0; i < SPAN; i++) {
+                cells[i] = static_cast<Cell>((key >> (2 * i)) & 3);
+            }
+            table[key] = score(cells);
+        }
+        return table;
+    }
+
+private:
+    static int popcount(int bits) {
+        int count = 0;
+        for (; bits; bits &= bits - 1) count++;
+        return count;
+    }
+
+    // Playing on an empty neighbour only turns 00 bits into 01, so every
+    // key it leads to is larger and already classified when keys are
+    // visited from the top down. A shape is graded by the best shape one
+    // more stone can turn it into.
+    static Threat classify(int key, const std::array<Threat, KEY_COUNT>& table) {
+        // 9-bit masks over the window, centre at bit REACH
+        int own = 1 << REACH;
+        int blocked = 0;
+        for (int i = 0; i < NEIGHBOURS; i++) {
+            int cell = (key >> (2 * i)) & 3;
+            int bit = 1 << (i < REACH ? i : i + 1);
+            if (cell == OWN) own |= bit;
+            else if (cell != EMPTY) blocked |= bit;
+        }
+
+        bool open = false;
+        int fiveCells = 0;  // window cells that complete five
+        for (int start = 0; start + SPAN <= NEIGHBOURS + 1; start++) {
+            int span = ((1 << SPAN) - 1) << start;
+            if (blocked & span) continue;
+            open = true;
+            int count = popcount(own & span);
+            if (count == SPAN) return FIVE;
+            if (count == SPAN - 1) fiveCells |= span & ~own;
+        }
+
+        if (fiveCells) return popcount(fiveCells) >= 2 ? OPEN_FOUR : FOUR;
+        if (!open) return NONE;
+
+        Threat best = ONE;
+        for (int i = 0; i < NEIGHBOURS; i++) {
+            if (((key >> (2 * i)) & 3) != EMPTY) continue;
+            Threat next = table[key | (OWN << (2 * i))];
+            if (next > best) best = next;
+        }
+
+        switch (best) {
+        case OPEN_FOUR: return run(window(key)) >= 3 ? OPEN_THREE : SPLIT_THREE;
+        case FOUR: return BLOCKED_THREE;
+        case OPEN_THREE:
+        case SPLIT_THREE: return OPEN_TWO;
+        case BLOCKED_THREE: return BLOCKED_TWO;
+        default: return ONE;
+        }
+    }
+
+    static std::array<Threat, KEY_COUNT> classifyAll() {
+        std::array<Threat, KEY_COUNT> table{};
+        for (int key = KEY_COUNT - 1; key >= 0; key--) {
+            table[key] = classify(key, table);
+        }
+        return table;
+    }
+
+    static constexpr std::array<uint16_t, 256> spread() {
+        std::array<uint16_t, 256> table{};
+        for (int bits = 0; bits < 256; bits++) {
+            for (int i = 0; i < 8; i++) {
+                if (bits & (1 << i)) table[bits] |= uint16_t(1u << (2 * i));
+            }
+        }
+        return table;
+    }
+
+    static const std::array<Threat, KEY_COUNT> THREATS;
+    static const std::array<uint16_t, 256> SPREAD;
+};
+
+inline const std::array<LinePatterns::Threat, LinePatterns::KEY_COUNT> LinePatterns::THREATS =
+    LinePatterns::classifyAll();
+inline constexpr std::array<uint16_t, 256> LinePatterns::SPREAD = LinePatterns::spread();
@@ -0,0 +1,236 @@
+// Gomocup/Piskvork protocol front-end over libgomoku, so tournament
+// managers can drive the opus engine.
+//
+// Commands arrive one per line on stdin; replies go to stdout. Supported:
+// START, RESTART, BEGIN, TURN, BOARD ... DONE, TAKEBACK, INFO, ABOUT and
+// END. Coordinates are x,y with x the column. Only 15x15 freestyle is
+// played. INFO timeout_turn, timeout_match and time_left set the budget of
+// each search, and INFO max_memory the size of the transposition table.
+// With --mcts the Monte Carlo tree search engine plays instead of
+// alpha-beta, and max_memory sizes its node pool; the opening book only
+// serves alpha-beta.
+//
+// Managers only launch executables named pbrain-*.
+//
+// Usage: pbrain-opus [--threads <n>] [--book <file>] [--mcts]
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+#include "engine.h"
+#include "mcts.h"
+#include "opening_book.h"
+
+using namespace gomoku;
+
+class PiskvorkBrain {
+private:
+    static constexpr size_t DEFAULT_HASH_MB = 64;
+    static constexpr size_t MAX_HASH_MB = 1024;
+    static constexpr long long MOVES_TO_GO = 25;   // share of the match clock one move may use
+    static constexpr long long SAFETY_MS = 60;     // reply, process start-up and scheduling
+    
+    Engine engine;
+    MctsEngine mcts;
+    bool useMcts;
+    Board board;
+    int threads;
+    
+    // Limits from INFO, in milliseconds; zero match time: no match limit
+    long long timeoutTurn;
+    long long timeoutMatch;
+    long long timeLeft;
+    
+    static void reply(const std::string& line) { std::cout << line << std::endl; }
+    
+    static bool parsePoint(const std::string& text, int& x, int& y, int* field = nullptr) {
+        std::istringstream in(text);
+        char comma;
+        if (!(in >> x >> comma >> y) || comma != ',') return false;
+        if (field && !(in >> comma >> *field && comma == ',')) return false;
+        return x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE;
+    }
+    
+    // The per-turn limit, or an even share of the match time left when that
+    // is shorter, less a margin so the reply arrives in time. The engine's
+    // forced-win check stops at a quarter of this budget, so it needs no
+    // reserve of its own.
+    std::chrono::milliseconds moveBudget() const {
+        long long budget = timeoutTurn;
+        if (timeoutMatch > 0) budget = std::min(budget, timeLeft / MOVES_TO_GO);
+        budget -= budget / 20 + SAFETY_MS;
+        return std::chrono::milliseconds(std::max(1LL, budget));
+    }
+    
+    void think() {
+        SearchLimits limits;
+        limits.depth = MAX_PLY - 1;
+        limits.time = moveBudget();
+        limits.threads = threads;
+        Position move = (useMcts ? mcts.search(board, limits) : engine.search(board, limits)).move;
+        board.placeStone(move.row, move.col, board.sideToMove());
+        reply(std::to_string(move.col) + "," + std::to_string(move.row));
+    }
+    
+    // BOARD lists the stones as x,y,field with field 1 for own stones and 2
+    // for the opponent's; 3 marks a continuous-game winning line and is
+    // ignored. Colours follow from the counts: with as many own stones as
+    // opponent stones we are black.
+    void readBoard() {
+        std::vector<Position> own, opponent;
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line == "DONE") break;
+            int x, y, field;
+            if (!parsePoint(line, x, y, &field)) continue;
+            if (field == 1) own.emplace_back(y, x);
+            else if (field == 2) opponent.emplace_back(y, x);
+        }
+        
+        board = Board();
+        Stone ownStone = own.size() == opponent.size() ? Stone::BLACK : Stone::WHITE;
+        // Alternate the colours, black first, so the move history reads
+        // like a game and its last entry is the opponent's last move
+        const auto& black = ownStone == Stone::BLACK ? own : opponent;
+        const auto& white = ownStone == Stone::BLACK ? opponent : own;
+        for (size_t i = 0; i < std::max(black.size(), white.size()); i++) {
+            if (i < black.size()) board.placeStone(black[i].row, black[i].col, Stone::BLACK);
+            if (i < white.size()) board.placeStone(white[i].row, white[i].col, Stone::WHITE);
+        }
+        think();
+    }
+    
+    // Replays the game without the taken-back stone, so any stone can be
+    // taken back and the move history stays in order
+    bool takeBack(int row, int col) {
+        if (board.getStone(row, col) == Stone::EMPTY) return false;
+        std::vector<Position> history = board.getMoveHistory();
+        Board replay;
+        for (const auto& pos : history) {
+            if (pos.row == row && pos.col == col) continue;
+            replay.placeStone(pos.row, pos.col, board.getStone(pos.row, pos.col));
+        }
+        board = replay;
+        return true;
+    }
+    
+    void setInfo(const std::string& key, long long value) {
+        if (key == "timeout_turn") {
+            timeoutTurn = value;
+        } else if (key == "timeout_match") {
+            timeoutMatch = value;
+        } else if (key == "time_left") {
+            timeLeft = value;
+        } else if (key == "max_memory") {
+            // Half the allowance for the table leaves room for the rest of
+            // the process; the table rounds its size down to a power of two
+            size_t megabytes = value > 0 ? static_cast<size_t>(value / 2) >> 20 : DEFAULT_HASH_MB;
+            megabytes = std::clamp<size_t>(megabytes, 1, MAX_HASH_MB);
+            if (useMcts) {
+                mcts.setTreeSize(megabytes);
+            } else {
+                engine.setHashSize(megabytes);
+            }
+        }
+    }
+    
+public:
+    explicit PiskvorkBrain(int threads = 1, bool useMcts = false)
+        : engine(useMcts ? 1 : DEFAULT_HASH_MB), mcts(useMcts ? DEFAULT_HASH_MB : 1), useMcts(useMcts), threads(threads),
+          timeoutTurn(30000), timeoutMatch(0), timeLeft(2147483647) {}
+    
+    void setOpeningBook(const OpeningBook* book) { engine.setOpeningBook(book); }
+    
+    // Answers commands until END or the end of input
+    void run() {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            std::istringstream in(line);
+            std::string command, argument;
+            in >> command;
+            std::transform(command.begin(), command.end(), command.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            std::getline(in >> std::ws, argument);
+            
+            int x, y;
+            if (command == "START") {
+                if (std::atoi(argument.c_str()) != BOARD_SIZE) {
+                    reply("ERROR only " + std::to_string(BOARD_SIZE) + "x" + std::to_string(BOARD_SIZE) + " boards are supported");
+                    continue;
+                }
+                board = Board();
+                engine.clear();
+                reply("OK");
+            } else if (command == "RECTSTART") {
+                reply("ERROR rectangular boards are not supported");
+            } else if (command == "RESTART") {
+                board = Board();
+                engine.clear();
+                reply("OK");
+            } else if (command == "BEGIN") {
+                think();
+            } else if (command == "TURN") {
+                if (!parsePoint(argument, x, y) || !board.placeStone(y, x, board.sideToMove())) {
+                    reply("ERROR invalid move " + argument);
+                    continue;
+                }
+                think();
+            } else if (command == "BOARD") {
+                readBoard();
+            } else if (command == "TAKEBACK") {
+                reply(parsePoint(argument, x, y) && takeBack(y, x) ? "OK" : "ERROR no stone at " + argument);
+            } else if (command == "INFO") {
+                std::istringstream info(argument);
+                std::string key;
+                long long value;
+                if (info >> key >> value) setInfo(key, value);
+            } else if (command == "ABOUT") {
+                reply("name=\"opus\", version=\"1.0\"");
+            } else if (command == "END") {
+                break;
+            } else if (!command.empty()) {
+                reply("UNKNOWN " + command);
+            }
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int threads = 1;
+    bool useMcts = false;
+    std::string bookPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--threads") {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--book") {
+            bookPath = argv[++i];
+        } else if (arg == "--mcts") {
+            useMcts = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--threads <n>] [--book <file>] [--mcts]" << std::endl;
+            return 1;
+        }
+    }
+    
+    PiskvorkBrain brain(threads, useMcts);
+    OpeningBook book;
+    if (!bookPath.empty()) {
+        if (!book.open(bookPath)) {
+            std::cerr << "Cannot open opening book " << bookPath << std::endl;
+            return 1;
+        }
+        brain.setOpeningBook(&book);
+    }
+    brain.run();
+    return 0;
+}
@@ -0,0 +1,157 @@
+// transposition_table.h - Fixed-size transposition table for the alpha-beta searchers
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Power-of-two number of 64-byte buckets, four 16-byte entries each. A store
+// overwrites the entry with the same key if there is one, otherwise the
+// shallowest entry in the bucket, preferring entries left over from earlier
+// searches.
+//
+// Safe to share between search threads without locks: each slot holds the
+// packed entry and its key xored with it, both written with relaxed atomics.
+// A slot torn by a concurrent write fails the key check and reads as a miss.
+class TranspositionTable {
+public:
+    enum class Bound : uint8_t { NONE = 0, EXACT, LOWER, UPPER };
+
+    static constexpr int NO_MOVE = 255;
+
+    struct Entry {
+        uint64_t key = 0;
+        int32_t score = 0;
+        uint8_t move = NO_MOVE;  // cell index (row * 15 + col)
+        int8_t depth = 0;        // remaining search depth
+        Bound bound = Bound::NONE;
+        uint8_t age = 0;
+    };
+
+    explicit TranspositionTable(size_t megabytes = 16) : bucketCount(0), mask(0), age(0) {
+        resize(megabytes);
+    }
+
+    // Not safe while a search is running
+    void resize(size_t megabytes) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) {
+            count *= 2;
+        }
+        buckets = std::make_unique<Bucket[]>(count);
+        bucketCount = count;
+        mask = count - 1;
+    }
+
+    // Not safe while a search is running
+    void clear() {
+        for (size_t i = 0; i < bucketCount; i++) {
+            for (Slot& slot : buckets[i].slots) {
+                slot.check.store(0, std::memory_order_relaxed);
+                slot.data.store(0, std::memory_order_relaxed);
+            }
+        }
+        age = 0;
+    }
+
+    // Call once per root search so older entries become preferred victims
+    void newSearch() { age++; }
+
+    size_t sizeInBytes() const { return bucketCount * sizeof(Bucket); }
+
+    bool probe(uint64_t key, Entry& out) const {
+        const Bucket& bucket = buckets[key & mask];
+        for (const Slot& slot : bucket.slots) {
+            Entry entry = slot.load();
+            if (entry.key == key && entry.bound != Bound::NONE) {
+                out = entry;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(uint64_t key, int depth, Bound bound, int score, int move) {
+        Bucket& bucket = buckets[key & mask];
+        Slot* victim = &bucket.slots[0];
+        Entry old = victim->load();
+        int victimWorth = 1 << 30;
+        uint8_t currentAge = age;
+
+        for (Slot& slot : bucket.slots) {
+            Entry entry = slot.load();
+            if (entry.key == key || entry.bound == Bound::NONE) {
+                victim = &slot;
+                old = entry;
+                break;
+            }
+            int worth = entry.depth - 4 * static_cast<uint8_t>(currentAge - entry.age);
+            if (worth < victimWorth) {
+                victimWorth = worth;
+                victim = &slot;
+                old = entry;
+            }
+        }
+
+        // Keep a deeper exact result for the same position from this search
+        if (old.key == key && old.age == currentAge && old.depth > depth &&
+            old.bound == Bound::EXACT && bound != Bound::EXACT) {
+            return;
+        }
+
+        if (move == NO_MOVE && old.key == key) {
+            move = old.move;
+        }
+
+        Entry entry;
+        entry.key = key;
+        entry.score = score;
+        entry.move = static_cast<uint8_t>(move);
+        entry.depth = static_cast<int8_t>(depth);
+        entry.bound = bound;
+        entry.age = currentAge;
+        victim->save(entry);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};  // key ^ data
+        std::atomic<uint64_t> data{0};
+
+        // data layout: score (32) | move (8) | depth (8) | bound (8) | age (8)
+        Entry load() const {
+            uint64_t d = data.load(std::memory_order_relaxed);
+            uint64_t k = check.load(std::memory_order_relaxed) ^ d;
+            Entry entry;
+            entry.key = k;
+            entry.score = static_cast<int32_t>(static_cast<uint32_t>(d));
+            entry.move = static_cast<uint8_t>(d >> 32);
+            entry.depth = static_cast<int8_t>(d >> 40);
+            entry.bound = static_cast<Bound>(static_cast<uint8_t>(d >> 48));
+            entry.age = static_cast<uint8_t>(d >> 56);
+            return entry;
+        }
+
+        void save(const Entry& entry) {
+            uint64_t d = static_cast<uint64_t>(static_cast<uint32_t>(entry.score)) |
+                         static_cast<uint64_t>(entry.move) << 32 |
+                         static_cast<uint64_t>(static_cast<uint8_t>(entry.depth)) << 40 |
+                         static_cast<uint64_t>(entry.bound) << 48 |
+                         static_cast<uint64_t>(entry.age) << 56;
+            check.store(entry.key ^ d, std::memory_order_relaxed);
+            data.store(d, std::memory_order_relaxed);
+        }
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[4];
+    };
+
+    static_assert(sizeof(Slot) == 16, "four slots must fill one cache line");
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount;
+    size_t mask;
+    uint8_t age;
+};
@@ -0,0 +1,40 @@
+// zobrist.h - Zobrist keys shared by the Gomoku engines
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Keys are generated at compile time from a fixed seed, so every program
+// hashes the same position to the same 64-bit value (opening books rely
+// on this).
+class Zobrist {
+public:
+    static constexpr int BOARD_CELLS = 15 * 15;
+
+    // color: 0 = black, 1 = white; cell: row * 15 + col
+    static uint64_t stone(int color, int cell) { return TABLE[color * BOARD_CELLS + cell]; }
+
+    // Xored in when it is the second player's turn to move
+    static uint64_t sideToMove() { return TABLE[2 * BOARD_CELLS]; }
+
+private:
+    static constexpr uint64_t splitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static constexpr std::array<uint64_t, 2 * BOARD_CELLS + 1> generate() {
+        std::array<uint64_t, 2 * BOARD_CELLS + 1> table{};
+        uint64_t state = 0x476F6D6F6B75ULL;
+        for (auto& key : table) {
+            key = splitMix64(state);
+        }
+        return table;
+    }
+
+    static const std::array<uint64_t, 2 * BOARD_CELLS + 1> TABLE;
+};
+
+inline constexpr std::array<uint64_t, 2 * Zobrist::BOARD_CELLS + 1> Zobrist::TABLE = Zobrist::generate();